@@ -0,0 +1,23 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+
+// Benchmarks are linked with -Wl,--wrap=malloc (and calloc/realloc) so
+// that every heap allocation made by the simulator is counted here
+extern uint64_t bench_alloc_count;
+
+// current monotonic time in nanoseconds
+static inline uint64_t bench_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
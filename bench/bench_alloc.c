@@ -0,0 +1,37 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bench.h"
+
+
+uint64_t bench_alloc_count = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+
+
+/* Allocation counting wrappers (see bench.h) */
+
+void* __wrap_malloc(size_t size) {
+  bench_alloc_count++;
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+  bench_alloc_count++;
+  return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* p, size_t size) {
+  bench_alloc_count++;
+  return __real_realloc(p, size);
+}
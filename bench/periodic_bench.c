@@ -0,0 +1,194 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// Periodic task set benchmark
+//
+// Builds a large set of periodic tasks, runs them to completion under a
+// minimal FIFO realtime scheduler, and reports how many heap allocations
+// the simulator makes while loading and while running.  Once loaded, a
+// periodic task re-arms its own arrival event, so the run phase should
+// perform zero allocations no matter how many periods elapse.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "context.h"
+#include "event.h"
+#include "eventqueue.h"
+#include "job.h"
+#include "jobqueue.h"
+#include "scheduler.h"
+
+
+#define DEFAULT_NUM_TASKS 2000
+#define DEFAULT_NUM_ITERS 50
+
+// total utilization of the task set, kept below 1 so queues stay short
+#define UTILIZATION 0.8
+
+
+/* Minimal FIFO scheduler for periodic tasks */
+
+typedef struct sched_state {
+  sim_sched_t* sim;
+  bool busy;
+  sim_event_t done_event;
+} sched_state_t;
+
+static int init(void* state, sim_context_t* context) {
+  sched_state_t* s = (sched_state_t*)state;
+
+  s->busy = false;
+  sim_event_init_embedded(&s->done_event, SIM_EVENT_JOB_DONE);
+
+  return 0;
+}
+
+static sim_sched_acceptance_t periodic_job_arrival(void*          state,
+                                                   sim_context_t* context,
+                                                   sim_time_t     current_time,
+                                                   sim_job_t*     job) {
+  sched_state_t* s = (sched_state_t*)state;
+
+  sim_job_queue_enqueue(&context->realtime_queue, job);
+
+  if (!s->busy) {
+    sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                               current_time + job->size, job);
+    s->busy = true;
+  }
+
+  return SIM_SCHED_ACCEPT;
+}
+
+static void job_done(void*          state,
+                     sim_context_t* context,
+                     sim_time_t     current_time,
+                     sim_job_t*     job) {
+  sched_state_t* s = (sched_state_t*)state;
+
+  sim_job_queue_remove(&context->realtime_queue, job);
+  s->busy = false;
+
+  if (sim_job_complete(context, job)) {
+    fprintf(stderr, "failed to complete job\n");
+    exit(-1);
+  }
+
+  sim_job_t* next = sim_job_queue_peek(&context->realtime_queue);
+  if (next) {
+    sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                               current_time + next->size, next);
+    s->busy = true;
+  }
+}
+
+static void timer_interrupt(void*          state,
+                            sim_context_t* context,
+                            sim_time_t     current_time) {
+}
+
+static sim_sched_ops_t ops = {
+  .init = init,
+
+  .periodic_job_arrival  = periodic_job_arrival,
+  .sporadic_job_arrival  = NULL,
+  .aperiodic_job_arrival = NULL,
+
+  .job_done        = job_done,
+  .timer_interrupt = timer_interrupt,
+};
+
+static sched_state_t bench_state;
+
+__attribute__((constructor)) void periodic_bench_sched_init() {
+  bench_state.sim = sim_sched_register("periodic_bench_sched", &bench_state, &ops);
+}
+
+
+/* Benchmark driver */
+
+// write a workload of periodic tasks with random periods in [1,10)
+// each task gets an equal share of the total utilization
+static int write_workload(char* path, uint64_t num_tasks, uint64_t num_iters) {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    return -1;
+  }
+
+  for (uint64_t i = 0; i < num_tasks; i++) {
+    double arrival = (double)rand() / RAND_MAX;
+    double period  = 1.0 + 9.0 * rand() / RAND_MAX;
+    double size    = period * UTILIZATION / num_tasks;
+    fprintf(f, "%lf PERIODIC_TASK_ARRIVAL %lf %lf %lu\n", arrival, period, size, num_iters);
+  }
+
+  fclose(f);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  uint64_t num_tasks = argc > 1 ? strtoull(argv[1], 0, 0) : DEFAULT_NUM_TASKS;
+  uint64_t num_iters = argc > 2 ? strtoull(argv[2], 0, 0) : DEFAULT_NUM_ITERS;
+
+  srand(343);
+
+  char path[] = "/tmp/queuesim_periodic_benchXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0 || write_workload(path, num_tasks, num_iters)) {
+    fprintf(stderr, "cannot write workload to %s\n", path);
+    return -1;
+  }
+  close(fd);
+
+  sim_context_t context;
+  if (sim_context_init(&context, "periodic_bench_sched", sim_time_from_double(0.01), NULL)) {
+    fprintf(stderr, "cannot initialize context (run from the top-level directory)\n");
+    return -1;
+  }
+
+  uint64_t load_allocs = bench_alloc_count;
+  uint64_t load_start  = bench_now_ns();
+  if (sim_context_load_events(&context, path)) {
+    fprintf(stderr, "cannot load workload\n");
+    return -1;
+  }
+  uint64_t load_ns = bench_now_ns() - load_start;
+  load_allocs = bench_alloc_count - load_allocs;
+  unlink(path);
+
+  if (sim_context_begin(&context)) {
+    fprintf(stderr, "cannot begin\n");
+    return -1;
+  }
+
+  uint64_t run_allocs = bench_alloc_count;
+  uint64_t run_start  = bench_now_ns();
+  uint64_t count      = 0;
+  sim_event_t* event;
+  while ((event = sim_context_get_next_event(&context))) {
+    sim_context_dispatch_event(&context, event);
+    count++;
+  }
+  uint64_t run_ns = bench_now_ns() - run_start;
+  run_allocs = bench_alloc_count - run_allocs;
+
+  printf("periodic_bench: %lu tasks x %lu iterations\n", num_tasks, num_iters);
+  printf("  load: %lu allocations in %.3lf ms\n", load_allocs, load_ns / 1e6);
+  printf("  run:  %lu events, %lu allocations (%.4lf per event) in %.3lf ms, %.0lf events/s\n",
+         count, run_allocs, count ? (double)run_allocs / count : 0.0,
+         run_ns / 1e6, run_ns ? count / (run_ns / 1e9) : 0.0);
+
+  sim_context_deinit(&context);
+  return 0;
+}
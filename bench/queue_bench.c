@@ -0,0 +1,267 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// Event queue and job queue microbenchmark
+//
+// Measures the cost of each queue operation under the hold model: the
+// queue is filled to a size n, then each operation takes an element out
+// and puts one back, so the size stays at n while the operations run.
+// Times to hold are exponential with a mean of n, so new events land all
+// over the queue rather than always at one end.  Each operation runs for
+// a fixed time budget at each size, and is reported in ns and heap
+// allocations per operation.
+//
+//   event post+get      get the earliest event, post a new one (as the
+//                       simulation does for every non-embedded event)
+//   event delete+post   delete a random event, post it again later (as
+//                       a reschedule of a pending event does)
+//   job enqueue+dequeue enqueue at the end, dequeue from the front (FIFO)
+//   job in-order        enqueue in order of size, dequeue the smallest
+//   job remove+enqueue  remove a random job, enqueue it at the end
+//
+// Sizes run from 10^2 to 10^max, where max is the first argument
+// (default 5, at most 7).  Both queues are sorted lists, so operations
+// that walk them grow linearly with n and the largest sizes take a while.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "event.h"
+#include "eventqueue.h"
+#include "generator.h"
+#include "job.h"
+#include "jobqueue.h"
+
+
+#define DEFAULT_MAX_EXP 5
+#define MAX_EXP         7
+
+// each operation runs in chunks until the budget is spent
+#define BUDGET_NS (200 * 1000 * 1000ULL)
+#define CHUNK     100
+#define MAX_OPS   (10 * 1000 * 1000ULL)
+
+
+static sim_rng_t rng;
+
+static sim_time_t exp_ticks(double mean) {
+  return sim_time_from_double(-log(1.0 - sim_rng_uniform(&rng)) * mean);
+}
+
+static uint64_t random_index(uint64_t n) {
+  return (uint64_t)(sim_rng_uniform(&rng) * n);
+}
+
+typedef struct bench_result {
+  uint64_t ops;
+  uint64_t ns;
+  uint64_t allocs;
+} bench_result_t;
+
+static void report(char* name, uint64_t n, bench_result_t* r) {
+  printf("  %-20s %9lu %10lu ops %10.1lf ns/op %8.3lf allocs/op\n",
+         name, n, r->ops, (double)r->ns / r->ops, (double)r->allocs / r->ops);
+}
+
+
+/* Event queue */
+
+typedef struct event_bench {
+  sim_event_queue_t eq;
+  sim_event_t** events; // every event in the queue, for random deletes
+  uint64_t n;
+} event_bench_t;
+
+static int event_bench_fill(event_bench_t* b, uint64_t n) {
+  sim_event_queue_init(&b->eq);
+  b->n = n;
+  if (!(b->events = malloc(n * sizeof(sim_event_t*)))) {
+    return -1;
+  }
+
+  // in time order, so filling appends
+  sim_time_t t = 0;
+  for (uint64_t i = 0; i < n; i++) {
+    t += exp_ticks(1.0);
+    if (!(b->events[i] = sim_event_create(t, SIM_EVENT_TIMER, NULL))) {
+      return -1;
+    }
+    sim_event_queue_post(&b->eq, b->events[i]);
+  }
+
+  return 0;
+}
+
+static void event_bench_free(event_bench_t* b) {
+  sim_event_t* e;
+  while ((e = sim_event_queue_get_earliest_event(&b->eq))) {
+    free(e);
+  }
+  free(b->events);
+}
+
+static void event_post_get(event_bench_t* b, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    sim_event_t* e = sim_event_queue_get_earliest_event(&b->eq);
+    sim_event_t* f = sim_event_create(b->eq.curtime + exp_ticks(b->n), SIM_EVENT_TIMER, NULL);
+    sim_event_queue_post(&b->eq, f);
+    sim_event_complete(e);
+    free(e);
+  }
+}
+
+static void event_delete_post(event_bench_t* b, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    sim_event_t* e = b->events[random_index(b->n)];
+    sim_event_queue_delete(&b->eq, e);
+    e->timestamp += exp_ticks(b->n);
+    sim_event_queue_post(&b->eq, e);
+  }
+}
+
+static bench_result_t run_event(uint64_t n, void (*op)(event_bench_t*, uint64_t)) {
+  bench_result_t r = { 0 };
+  event_bench_t b;
+
+  if (event_bench_fill(&b, n)) {
+    fprintf(stderr, "cannot allocate %lu events\n", n);
+    exit(-1);
+  }
+
+  uint64_t allocs = bench_alloc_count;
+  uint64_t start  = bench_now_ns();
+  while (r.ns < BUDGET_NS && r.ops < MAX_OPS) {
+    op(&b, CHUNK);
+    r.ops += CHUNK;
+    r.ns   = bench_now_ns() - start;
+  }
+  r.allocs = bench_alloc_count - allocs;
+
+  event_bench_free(&b);
+  return r;
+}
+
+
+/* Job queue */
+
+typedef struct job_bench {
+  sim_job_queue_t jq;
+  sim_job_t* jobs; // every job, in the queue or not
+  uint64_t n;
+} job_bench_t;
+
+static int by_size(sim_job_t* lhs, sim_job_t* rhs) {
+  return lhs->size < rhs->size ? -1 : lhs->size > rhs->size;
+}
+
+static int job_bench_fill(job_bench_t* b, uint64_t n) {
+  sim_job_queue_init(&b->jq);
+  b->n = n;
+  if (posix_memalign((void**)&b->jobs, SIM_JOB_ALIGN, n * sizeof(sim_job_t))) {
+    return -1;
+  }
+  memset(b->jobs, 0, n * sizeof(sim_job_t));
+
+  // sizes already in order, so the in-order queue fills by appending
+  sim_time_t size = 0;
+  for (uint64_t i = 0; i < n; i++) {
+    size += exp_ticks(1.0);
+    b->jobs[i].size = b->jobs[i].remaining_size = size;
+    b->jobs[i].type = SIM_JOB_APERIODIC;
+    sim_job_queue_enqueue(&b->jq, &b->jobs[i]);
+  }
+
+  return 0;
+}
+
+static void job_enqueue_dequeue(job_bench_t* b, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    sim_job_t* j = sim_job_queue_dequeue(&b->jq);
+    sim_job_queue_enqueue(&b->jq, j);
+  }
+}
+
+static void job_in_order(job_bench_t* b, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    sim_job_t* j = sim_job_queue_dequeue(&b->jq);
+    j->size += exp_ticks(b->n);
+    sim_job_queue_enqueue_in_order(&b->jq, j, by_size);
+  }
+}
+
+static void job_remove_enqueue(job_bench_t* b, uint64_t ops) {
+  for (uint64_t i = 0; i < ops; i++) {
+    sim_job_t* j = &b->jobs[random_index(b->n)];
+    sim_job_queue_remove(&b->jq, j);
+    sim_job_queue_enqueue(&b->jq, j);
+  }
+}
+
+static bench_result_t run_job(uint64_t n, void (*op)(job_bench_t*, uint64_t)) {
+  bench_result_t r = { 0 };
+  job_bench_t b;
+
+  if (job_bench_fill(&b, n)) {
+    fprintf(stderr, "cannot allocate %lu jobs\n", n);
+    exit(-1);
+  }
+
+  uint64_t allocs = bench_alloc_count;
+  uint64_t start  = bench_now_ns();
+  while (r.ns < BUDGET_NS && r.ops < MAX_OPS) {
+    op(&b, CHUNK);
+    r.ops += CHUNK;
+    r.ns   = bench_now_ns() - start;
+  }
+  r.allocs = bench_alloc_count - allocs;
+
+  free(b.jobs);
+  return r;
+}
+
+
+/* Benchmark driver */
+
+int main(int argc, char** argv) {
+  int max_exp = argc > 1 ? atoi(argv[1]) : DEFAULT_MAX_EXP;
+  if (max_exp < 2 || max_exp > MAX_EXP) {
+    fprintf(stderr, "queue_bench [max exponent, 2 to %d]\n", MAX_EXP);
+    return -1;
+  }
+
+  sim_rng_seed(&rng, 343);
+
+  printf("queue_bench: hold model, sizes 10^2 to 10^%d\n", max_exp);
+  printf("  %-20s %9s\n", "operation", "size");
+
+  for (int e = 2; e <= max_exp; e++) {
+    uint64_t n = 1;
+    for (int i = 0; i < e; i++) {
+      n *= 10;
+    }
+
+    bench_result_t r;
+    r = run_event(n, event_post_get);
+    report("event post+get", n, &r);
+    r = run_event(n, event_delete_post);
+    report("event delete+post", n, &r);
+    r = run_job(n, job_enqueue_dequeue);
+    report("job enqueue+dequeue", n, &r);
+    r = run_job(n, job_in_order);
+    report("job in-order", n, &r);
+    r = run_job(n, job_remove_enqueue);
+    report("job remove+enqueue", n, &r);
+  }
+
+  return 0;
+}
@@ -0,0 +1,385 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// End-to-end simulator throughput benchmark
+//
+// Runs every registered scheduler over the bundled workloads/expexp*.txt
+// and over generated workloads of increasing size (10^3 up to 10^max
+// seconds of arrivals) and load, each in a child process with the logs
+// off, and reports the events per second, the wall time (of the best of
+// a few runs) and the peak resident set size of each.  A child repeats a
+// short simulation until it has run for MIN_RUN_SECS, and the time of one
+// simulation is the average.
+//
+// The results are compared against a baseline file and any run that got
+// slower or bigger by more than the threshold is flagged as a regression,
+// and any that dispatched a different number of events as changed (and
+// either fails the benchmark).  A baseline is only compared against a
+// build with the same optimization flags.  Without a baseline, or with
+// -r, the results are recorded as the new baseline instead.  Either way
+// they are written to logs/sim_bench.out, in the same format:
+//
+//   sim_bench [-r] [-t threshold] [-s max] [baseline]
+//
+//   -r            record the baseline rather than compare against it
+//   -t threshold  allowed fractional loss of events/s, or growth of
+//                 peak RSS (default 0.1)
+//   -s max        largest generated workload is 10^max seconds (default 5)
+//   baseline      default logs/sim_bench.baseline
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "context.h"
+#include "scheduler.h"
+
+
+#define DEFAULT_BASELINE  "logs/sim_bench.baseline"
+#define RESULTS           "logs/sim_bench.out"
+#define DEFAULT_THRESHOLD 0.1
+#define DEFAULT_MAX_EXP   5
+#define MAX_EXP           7
+#define REPEATS           3
+
+// the throughput of a simulation of a few ms is mostly noise, so each
+// child runs the simulation again until this much time has passed
+#define MIN_RUN_SECS 0.2
+
+// the optimization flags this was built with (set by the Makefile), as
+// timings from different flags cannot be compared
+#ifndef BENCH_OPT
+#define BENCH_OPT ""
+#endif
+#define FLAGS_PREFIX "# flags: "
+
+#define MAX_RESULTS 1024
+
+static char* bundled[] = {
+  "workloads/expexp0.5.txt",
+  "workloads/expexp0.9.txt",
+  "workloads/expexp0.95.txt",
+  "workloads/expexp0.99.txt",
+  "workloads/expexp1.5.txt",
+};
+
+// offered loads of the generated workloads
+static char* loads[] = { "0.5", "0.9" };
+
+typedef struct result {
+  char sched[SIM_SCHED_NAME_MAX];
+  char workload[128];
+  uint64_t events;
+  uint64_t runs;    // simulations the time is averaged over
+  double secs;      // of one simulation
+  double rate;      // events per second
+  uint64_t rss_kb;
+} result_t;
+
+
+/* Running one simulation */
+
+// what a child reports back
+typedef struct child_result {
+  uint64_t events;
+  uint64_t runs;
+  double secs; // of one simulation
+} child_result_t;
+
+// run the simulation once, counting the events it dispatched
+static int simulate(char* sched, char* workload, uint64_t* events) {
+  sim_log_config_t log_config;
+  sim_log_config_init(&log_config);
+  log_config.queuelen = log_config.events = log_config.jobs = log_config.trace = false;
+
+  sim_context_t* context = malloc(sizeof(*context));
+  if (!context ||
+      sim_context_init(context, sched, sim_time_from_double(0.01), &log_config) ||
+      sim_context_load_events(context, workload) ||
+      sim_context_begin(context)) {
+    return -1;
+  }
+
+  uint64_t count = 0;
+  sim_event_t* event;
+  while ((event = sim_context_get_next_event(context))) {
+    sim_context_dispatch_event(context, event);
+    count++;
+  }
+
+  sim_context_deinit(context);
+  free(context);
+  *events = count;
+  return 0;
+}
+
+// run the simulation in this (child) process until MIN_RUN_SECS have
+// passed, and write what it did to fd
+// every run must dispatch the same events, or the runs are not the same
+static void run_child(char* sched, char* workload, int fd) {
+  child_result_t c = { 0 };
+  uint64_t start   = bench_now_ns();
+
+  do {
+    uint64_t events;
+    if (simulate(sched, workload, &events) || (c.runs && events != c.events)) {
+      _exit(1);
+    }
+    c.events = events;
+    c.runs++;
+    c.secs = (bench_now_ns() - start) / 1e9;
+  } while (c.secs < MIN_RUN_SECS);
+  c.secs /= c.runs;
+
+  if (write(fd, &c, sizeof(c)) != sizeof(c)) {
+    _exit(1);
+  }
+  _exit(0);
+}
+
+// best of REPEATS runs, -1 if the simulation failed
+static int run(char* sched, char* workload, result_t* r) {
+  memset(r, 0, sizeof(*r));
+  snprintf(r->sched, sizeof(r->sched), "%s", sched);
+  snprintf(r->workload, sizeof(r->workload), "%s", workload);
+
+  for (int i = 0; i < REPEATS; i++) {
+    int fds[2];
+    if (pipe(fds)) {
+      return -1;
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+      return -1;
+    }
+    if (pid == 0) {
+      close(fds[0]);
+      run_child(sched, workload, fds[1]);
+    }
+    close(fds[1]);
+
+    child_result_t c;
+    bool ok = read(fds[0], &c, sizeof(c)) == sizeof(c);
+    close(fds[0]);
+
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !ok ||
+        !WIFEXITED(status) || WEXITSTATUS(status)) {
+      return -1;
+    }
+
+    if (i == 0 || c.secs < r->secs) {
+      r->secs = c.secs;
+      r->runs = c.runs;
+    }
+    if ((uint64_t)usage.ru_maxrss > r->rss_kb) {
+      r->rss_kb = usage.ru_maxrss;
+    }
+    r->events = c.events;
+  }
+
+  r->rate = r->events / r->secs;
+  return 0;
+}
+
+
+/* Baselines */
+
+static void write_result(FILE* f, result_t* r) {
+  fprintf(f, "%-16s %-40s %12lu %6lu %10.6lf %14.0lf %10lu\n",
+          r->sched, r->workload, r->events, r->runs, r->secs, r->rate, r->rss_kb);
+}
+
+static int write_results(char* path, result_t* results, int n) {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    fprintf(stderr, "cannot write %s\n", path);
+    return -1;
+  }
+  fprintf(f, FLAGS_PREFIX "%s\n", BENCH_OPT);
+  fprintf(f, "# scheduler workload events runs secs events/s peak_rss_kb\n");
+  for (int i = 0; i < n; i++) {
+    write_result(f, &results[i]);
+  }
+  return fclose(f);
+}
+
+// read a baseline and the flags it was built with (empty if it does not
+// say), returning the number of results or -1 if there is none
+static int read_results(char* path, result_t* results, int max, char* flags, size_t flags_size) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    return -1;
+  }
+
+  char line[512];
+  int n = 0;
+  flags[0] = 0;
+  while (n < max && fgets(line, sizeof(line), f)) {
+    result_t* r = &results[n];
+    if (!strncmp(line, FLAGS_PREFIX, strlen(FLAGS_PREFIX))) {
+      snprintf(flags, flags_size, "%s", line + strlen(FLAGS_PREFIX));
+      flags[strcspn(flags, "\n")] = 0;
+    } else if (line[0] != '#' &&
+               sscanf(line, "%31s %127s %lu %lu %lf %lf %lu",
+                      r->sched, r->workload, &r->events, &r->runs, &r->secs, &r->rate, &r->rss_kb) == 7) {
+      n++;
+    }
+  }
+
+  fclose(f);
+  return n;
+}
+
+static result_t* find_result(result_t* results, int n, result_t* r) {
+  for (int i = 0; i < n; i++) {
+    if (!strcmp(results[i].sched, r->sched) && !strcmp(results[i].workload, r->workload)) {
+      return &results[i];
+    }
+  }
+  return NULL;
+}
+
+// flag r if it regressed or changed from its baseline, returning 1 if it did
+// a different number of events means the simulation itself changed, and
+// its timings no longer measure the same work
+static int compare(result_t* r, result_t* base, double threshold) {
+  int regressed = 0;
+
+  if (!base) {
+    printf("    (not in baseline)\n");
+    return 0;
+  }
+  if (r->events != base->events) {
+    printf("    CHANGED: %lu events, baseline %lu\n", r->events, base->events);
+    return 1;
+  }
+  if (r->rate < base->rate * (1 - threshold)) {
+    printf("    REGRESSION: %.0lf events/s, baseline %.0lf (%+.1lf%%)\n",
+           r->rate, base->rate, 100 * (r->rate / base->rate - 1));
+    regressed = 1;
+  }
+  if (r->rss_kb > base->rss_kb * (1 + threshold)) {
+    printf("    REGRESSION: peak RSS %lu KB, baseline %lu KB\n", r->rss_kb, base->rss_kb);
+    regressed = 1;
+  }
+
+  return regressed;
+}
+
+
+/* Benchmark driver */
+
+static void usage(void) {
+  fprintf(stderr, "sim_bench [-r] [-t threshold] [-s max] [baseline]\n");
+  exit(-1);
+}
+
+int main(int argc, char** argv) {
+  bool record      = false;
+  double threshold = DEFAULT_THRESHOLD;
+  int max_exp      = DEFAULT_MAX_EXP;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "rt:s:")) != -1) {
+    switch (opt) {
+      case 'r':
+        record = true;
+        break;
+      case 't':
+        threshold = atof(optarg);
+        break;
+      case 's':
+        max_exp = atoi(optarg);
+        break;
+      default:
+        usage();
+    }
+  }
+  if (optind < argc - 1 || threshold <= 0 || max_exp < 3 || max_exp > MAX_EXP) {
+    usage();
+  }
+  char* baseline_path = optind < argc ? argv[optind] : DEFAULT_BASELINE;
+
+  // the workloads: the bundled ones, then generated ones growing in size
+  char* workloads[64];
+  int num_workloads = 0;
+  for (int i = 0; i < sizeof(bundled) / sizeof(bundled[0]); i++) {
+    workloads[num_workloads++] = bundled[i];
+  }
+  for (int e = 3; e <= max_exp; e++) {
+    for (int i = 0; i < sizeof(loads) / sizeof(loads[0]); i++) {
+      char spec[128];
+      snprintf(spec, sizeof(spec), "gen:expexp:1:%s:T=1e%d:seed=1", loads[i], e);
+      workloads[num_workloads++] = strdup(spec);
+    }
+  }
+
+  static result_t baseline[MAX_RESULTS];
+  static result_t results[MAX_RESULTS];
+  char baseline_flags[512];
+  int num_baseline = record ? -1 : read_results(baseline_path, baseline, MAX_RESULTS,
+                                                baseline_flags, sizeof(baseline_flags));
+  if (num_baseline >= 0 && strcmp(baseline_flags, BENCH_OPT)) {
+    fprintf(stderr, "sim_bench: %s was recorded with flags \"%s\", not \"%s\" (record a new one with -r)\n",
+            baseline_path, baseline_flags, BENCH_OPT);
+    return 1;
+  }
+  int num_results  = 0;
+  int regressions  = 0;
+  int failures     = 0;
+
+  printf("sim_bench: best of %d runs (flags \"%s\"), %s\n", REPEATS, BENCH_OPT,
+         num_baseline < 0 ? "recording baseline" : "comparing against baseline");
+  printf("  %-16s %-40s %12s %6s %10s %14s %10s\n",
+         "scheduler", "workload", "events", "runs", "secs", "events/s", "rss KB");
+
+  for (sim_sched_t* s = sim_sched_next(NULL); s; s = sim_sched_next(s)) {
+    for (int i = 0; i < num_workloads && num_results < MAX_RESULTS; i++) {
+      result_t* r = &results[num_results];
+      if (run(s->name, workloads[i], r)) {
+        printf("  %-16s %-40s FAILED\n", s->name, workloads[i]);
+        failures++;
+        continue;
+      }
+      num_results++;
+
+      printf("  ");
+      write_result(stdout, r);
+      if (num_baseline >= 0) {
+        regressions += compare(r, find_result(baseline, num_baseline, r), threshold);
+      }
+    }
+  }
+
+  if (write_results(RESULTS, results, num_results) ||
+      (num_baseline < 0 && write_results(baseline_path, results, num_results))) {
+    return -1;
+  }
+
+  if (num_baseline < 0) {
+    printf("sim_bench: baseline recorded in %s\n", baseline_path);
+  } else {
+    printf("sim_bench: %d regressions beyond %.0lf%% or changed event counts\n", regressions, threshold * 100);
+  }
+  if (failures) {
+    printf("sim_bench: %d runs failed\n", failures);
+  }
+
+  return regressions || failures ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// Statistics microbenchmark and merge check
+//
+// Times adding a value to each online statistic the simulation keeps for
+// every completed job (accumulator, histogram, batch means), in ns per
+// value, over 2^20 exponential values.
+//
+// Then checks that merging is the same as one pass: the values are split
+// in two, each half goes into its own statistics, and the halves are
+// merged (as sim_context_merge_stats() does for replications).  Counts and
+// histograms must match one pass over all the values exactly, and means,
+// variances and batch means to within rounding.  An uneven split is
+// checked too, except for the batch means, which only match when the
+// first half ends on a batch boundary.  Any mismatch fails the benchmark.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "generator.h"
+#include "stats.h"
+#include "trace.h"
+
+
+#define NUM_VALUES (1 << 20)
+
+// relative difference allowed between merged and one-pass values, which
+// are summed in a different order
+#define TOLERANCE 1e-12
+
+
+static double values[NUM_VALUES];
+
+typedef struct stats {
+  sim_accumulator_t acc;
+  sim_histogram_t hist;
+  sim_batch_means_t batches;
+} stats_t;
+
+static void stats_init(stats_t* s) {
+  sim_accumulator_init(&s->acc);
+  sim_histogram_init(&s->hist);
+  sim_batch_means_init(&s->batches);
+}
+
+static void stats_add(stats_t* s, uint64_t from, uint64_t to) {
+  for (uint64_t i = from; i < to; i++) {
+    sim_accumulator_add(&s->acc, values[i]);
+    sim_histogram_add(&s->hist, values[i]);
+    sim_batch_means_add(&s->batches, values[i]);
+  }
+}
+
+
+/* Timing */
+
+static void time_add(char* name, void* stat, void (*add)(void*, double)) {
+  uint64_t start = bench_now_ns();
+  for (uint64_t i = 0; i < NUM_VALUES; i++) {
+    add(stat, values[i]);
+  }
+  uint64_t ns = bench_now_ns() - start;
+  printf("  %-20s %10.1lf ns/value\n", name, (double)ns / NUM_VALUES);
+}
+
+static void add_accumulator(void* s, double v) {
+  sim_accumulator_add(s, v);
+}
+
+static void add_histogram(void* s, double v) {
+  sim_histogram_add(s, v);
+}
+
+static void add_batch_means(void* s, double v) {
+  sim_batch_means_add(s, v);
+}
+
+
+/* Checking merges */
+
+static bool close_to(double a, double b) {
+  return fabs(a - b) <= TOLERANCE * fmax(fabs(a), fabs(b));
+}
+
+// compare merged statistics against one pass, returning the mismatches
+static int compare(char* split, stats_t* merged, stats_t* one, bool batches) {
+  int bad = 0;
+
+#define CHECK(what, ok)                                          \
+  do {                                                           \
+    if (!(ok)) {                                                 \
+      printf("    MISMATCH: %s, split %s\n", what, split);       \
+      bad++;                                                     \
+    }                                                            \
+  } while (0)
+
+  CHECK("accumulator count", merged->acc.count == one->acc.count);
+  CHECK("accumulator sum", close_to(sim_accumulator_sum(&merged->acc), sim_accumulator_sum(&one->acc)));
+  CHECK("accumulator mean", close_to(sim_accumulator_mean(&merged->acc), sim_accumulator_mean(&one->acc)));
+  CHECK("accumulator variance",
+        close_to(sim_accumulator_variance(&merged->acc), sim_accumulator_variance(&one->acc)));
+
+  CHECK("histogram count", merged->hist.count == one->hist.count && merged->hist.zero == one->hist.zero);
+  CHECK("histogram range", merged->hist.min == one->hist.min && merged->hist.max == one->hist.max);
+  CHECK("histogram buckets", !memcmp(merged->hist.buckets, one->hist.buckets, sizeof(one->hist.buckets)));
+
+  if (batches) {
+    sim_batch_means_t* m = &merged->batches;
+    sim_batch_means_t* o = &one->batches;
+    CHECK("batch size", m->batch_size == o->batch_size && m->num_batches == o->num_batches &&
+                        m->in_batch == o->in_batch);
+    bool same = true;
+    for (int i = 0; i < m->num_batches && i < o->num_batches; i++) {
+      same = same && close_to(m->means[i], o->means[i]);
+    }
+    CHECK("batch means", same);
+    CHECK("batch means half-width",
+          close_to(sim_batch_means_halfwidth(m), sim_batch_means_halfwidth(o)));
+  }
+
+#undef CHECK
+  return bad;
+}
+
+// split the values at split, merge the halves, and compare with one pass
+static int check_merge(char* name, uint64_t split, stats_t* one, bool batches) {
+  static stats_t first, second;
+
+  stats_init(&first);
+  stats_init(&second);
+  stats_add(&first, 0, split);
+  stats_add(&second, split, NUM_VALUES);
+
+  sim_accumulator_merge(&first.acc, &second.acc);
+  sim_histogram_merge(&first.hist, &second.hist);
+  sim_batch_means_merge(&first.batches, &second.batches);
+
+  int bad = compare(name, &first, one, batches);
+  printf("  %-20s %s\n", name, bad ? "MISMATCH" : "matches one pass");
+  return bad;
+}
+
+
+int main(int argc, char** argv) {
+  // no simulation, so no trace to keep DEBUG() statements in
+  sim_time_t now = 0;
+  sim_trace_t trace;
+  sim_trace_init(&trace, SIM_TRACE_OFF, 0, &now);
+
+  sim_rng_t rng;
+  sim_rng_seed(&rng, 343);
+  sim_rng_fill_exp(&rng, values, NUM_VALUES, 1.0);
+
+  printf("stats_bench: %d exponential values\n", NUM_VALUES);
+
+  static stats_t timed;
+  stats_init(&timed);
+  time_add("accumulator add", &timed.acc, add_accumulator);
+  time_add("histogram add", &timed.hist, add_histogram);
+  time_add("batch means add", &timed.batches, add_batch_means);
+
+  static stats_t one;
+  stats_init(&one);
+  stats_add(&one, 0, NUM_VALUES);
+
+  int bad = 0;
+  bad += check_merge("merge halves", NUM_VALUES / 2, &one, true);
+  bad += check_merge("merge 1/3 + 2/3", NUM_VALUES / 3, &one, false);
+
+  if (bad) {
+    printf("stats_bench: %d mismatches\n", bad);
+  }
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,211 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// Workload ingestion benchmark
+//
+// Writes a large aperiodic workload in the format tools/make_arrivals.pl
+// produces, then measures how fast it is ingested: parsing alone with
+// the original fgets()/sscanf() loop, parsing alone with the workload
+// parser, reading the file (mapped) as text and as a binary workload,
+// and a full sim_context_load_events() that also creates every job and
+// event.  Rates are given relative to the size of the text workload.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "context.h"
+#include "scheduler.h"
+#include "workload.h"
+
+
+#define DEFAULT_NUM_LINES 1000000
+
+
+/* Scheduler that is never run, so a context can be created */
+
+static sim_sched_ops_t ops = { 0 };
+
+__attribute__((constructor)) void workload_bench_sched_init() {
+  sim_sched_register("workload_bench_sched", NULL, &ops);
+}
+
+
+/* Benchmark driver */
+
+// exponential interarrivals and sizes, printed like make_arrivals.pl does
+static int write_workload(char* path, uint64_t num_lines) {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    return -1;
+  }
+
+  double t = 0;
+  for (uint64_t i = 0; i < num_lines; i++) {
+    t += -log((rand() + 1.0) / (RAND_MAX + 2.0));
+    double size = -log((rand() + 1.0) / (RAND_MAX + 2.0)) * 0.9;
+    fprintf(f, "%.15g APERIODIC_JOB_ARRIVAL %.15g %d\n", t, size, rand() % 100);
+  }
+
+  fclose(f);
+  return 0;
+}
+
+// the parsing loop of the original loader, without creating anything
+static uint64_t parse_sscanf(char* path) {
+  FILE* in = fopen(path, "r");
+  char buf[1024];
+  char cmd[1024];
+  uint64_t count = 0;
+
+  while (fgets(buf, sizeof(buf), in)) {
+    double timestamp = 0, size = 0;
+    uint64_t priority = 0;
+    sscanf(buf, "%lf %s", &timestamp, cmd);
+    if (!strcasecmp(cmd, "APERIODIC_JOB_ARRIVAL")) {
+      sscanf(buf, "%lf %s %lf %lu", &timestamp, cmd, &size, &priority);
+      count += sim_time_from_double(size) > 0;
+    }
+  }
+
+  fclose(in);
+  return count;
+}
+
+static uint64_t parse_fast(char* data, size_t len) {
+  char* p   = data;
+  char* end = data + len;
+  uint64_t count = 0;
+
+  while (p < end) {
+    char* eol = memchr(p, '\n', end - p);
+    if (!eol) {
+      eol = end;
+    }
+    sim_workload_cmd_t cmd;
+    if (sim_workload_parse_line(p, eol, &cmd)) {
+      count += cmd.size > 0;
+    }
+    p = eol + 1;
+  }
+
+  return count;
+}
+
+static int count_cmd(void* arg, sim_workload_cmd_t* cmd) {
+  *(uint64_t*)arg += cmd->size > 0;
+  return 0;
+}
+
+static int add_cmd(void* arg, sim_workload_cmd_t* cmd) {
+  return sim_workload_writer_add((sim_workload_writer_t*)arg, cmd);
+}
+
+// convert the text workload at path into a binary one at bin_path
+static int write_binary(char* path, char* bin_path) {
+  sim_workload_writer_t w;
+  sim_workload_writer_init(&w);
+
+  FILE* f = fopen(bin_path, "w");
+  int rc  = !f || sim_workload_read(path, add_cmd, &w) ||
+           sim_workload_writer_write(&w, f);
+  if (f) {
+    rc |= fclose(f);
+  }
+
+  sim_workload_writer_deinit(&w);
+  return rc;
+}
+
+static void report(char* name, uint64_t ns, size_t bytes, uint64_t lines) {
+  printf("  %-16s %8.3lf ms  %8.1lf MB/s  %6.2lf M lines/s\n",
+         name, ns / 1e6, bytes / (ns / 1e9) / 1e6, lines / (ns / 1e9) / 1e6);
+}
+
+int main(int argc, char** argv) {
+  uint64_t num_lines = argc > 1 ? strtoull(argv[1], 0, 0) : DEFAULT_NUM_LINES;
+
+  srand(343);
+
+  char path[] = "/tmp/queuesim_workload_benchXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0 || write_workload(path, num_lines)) {
+    fprintf(stderr, "cannot write workload to %s\n", path);
+    return -1;
+  }
+  close(fd);
+
+  struct stat st;
+  stat(path, &st);
+  size_t bytes = st.st_size;
+
+  // file contents in memory, for parsing without I/O
+  char* data = malloc(bytes);
+  FILE* f    = fopen(path, "r");
+  if (!data || fread(data, 1, bytes, f) != bytes) {
+    fprintf(stderr, "cannot read back workload\n");
+    return -1;
+  }
+  fclose(f);
+
+  printf("workload_bench: %lu lines, %.1lf MB\n", num_lines, bytes / 1e6);
+
+  uint64_t start = bench_now_ns();
+  uint64_t n     = parse_sscanf(path);
+  report("sscanf parse", bench_now_ns() - start, bytes, n);
+
+  start = bench_now_ns();
+  n     = parse_fast(data, bytes);
+  report("workload parse", bench_now_ns() - start, bytes, n);
+
+  char bin_path[] = "/tmp/queuesim_workload_benchXXXXXX";
+  fd = mkstemp(bin_path);
+  if (fd < 0 || write_binary(path, bin_path)) {
+    fprintf(stderr, "cannot write binary workload to %s\n", bin_path);
+    return -1;
+  }
+  close(fd);
+
+  n     = 0;
+  start = bench_now_ns();
+  sim_workload_read(path, count_cmd, &n);
+  report("text read", bench_now_ns() - start, bytes, n);
+
+  n     = 0;
+  start = bench_now_ns();
+  sim_workload_read(bin_path, count_cmd, &n);
+  report("binary read", bench_now_ns() - start, bytes, n);
+
+  sim_context_t context;
+  sim_log_config_t log_config;
+  sim_log_config_init(&log_config);
+  log_config.queuelen = log_config.events = log_config.jobs = log_config.trace = false;
+  if (sim_context_init(&context, "workload_bench_sched", sim_time_from_double(0.01), &log_config)) {
+    fprintf(stderr, "cannot initialize context\n");
+    return -1;
+  }
+
+  start = bench_now_ns();
+  if (sim_context_load_events(&context, path)) {
+    fprintf(stderr, "cannot load workload\n");
+    return -1;
+  }
+  report("full load", bench_now_ns() - start, bytes, num_lines);
+
+  unlink(path);
+  unlink(bin_path);
+  free(data);
+  sim_context_deinit(&context);
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// queuesim-convert turns a text workload into the binary workload format,
+// which queuesim loads without parsing, or a binary workload back into text
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "workload.h"
+
+
+static void usage(void) {
+  fprintf(stderr, "queuesim-convert [binary|text] input output\n");
+  fprintf(stderr, "  converts a workload (text or binary) to binary (default) or text\n");
+  exit(-1);
+}
+
+static int add_to_writer(void* arg, sim_workload_cmd_t* cmd) {
+  return sim_workload_writer_add((sim_workload_writer_t*)arg, cmd);
+}
+
+static int print_cmd(void* arg, sim_workload_cmd_t* cmd) {
+  sim_workload_print_cmd((FILE*)arg, cmd);
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 4) {
+    usage();
+  }
+
+  bool text = false;
+  char* in  = argv[argc - 2];
+  char* out = argv[argc - 1];
+  if (argc == 4) {
+    if (!strcmp(argv[1], "text")) {
+      text = true;
+    } else if (strcmp(argv[1], "binary")) {
+      usage();
+    }
+  }
+
+  FILE* f = fopen(out, "w");
+  if (!f) {
+    fprintf(stderr, "Can't open %s\n", out);
+    exit(-1);
+  }
+
+  int rc;
+  if (text) {
+    rc = sim_workload_read(in, print_cmd, f);
+  } else {
+    sim_workload_writer_t w;
+    sim_workload_writer_init(&w);
+    rc = sim_workload_read(in, add_to_writer, &w);
+    if (!rc) {
+      rc = sim_workload_writer_write(&w, f);
+    }
+    sim_workload_writer_deinit(&w);
+  }
+
+  if (fclose(f) || rc) {
+    fprintf(stderr, "Can't convert %s to %s\n", in, out);
+    exit(-1);
+  }
+
+  return 0;
+}
@@ -11,6 +11,8 @@
 
 #include <stdio.h>
 
+#include "trace.h"
+
 
 // enable your debugging options here
 // if debug is on for a support module, that module's DEBUG() statements will print
@@ -19,11 +21,30 @@
 #define DEBUG_JOB          1
 #define DEBUG_JOB_QUEUE    1
 #define DEBUG_CONTEXT      1
+#define DEBUG_LOG_WRITER   1
+#define DEBUG_LOG_FORMAT   1
+#define DEBUG_WORKLOAD     1
+#define DEBUG_GENERATOR    1
+#define DEBUG_STATS        1
+#define DEBUG_PROFILE      1
+
+// 1 sends DEBUG() statements to the trace (see support/trace.h), which is
+// cheap enough to leave on, 0 prints each one to stderr as it happens
+#define DEBUG_TRACE        1
+
+// 1 compiles in the hot-path profile probes (see support/profile.h), which
+// cost a predictable branch each unless QUEUESIM_PROFILE turns them on,
+// 0 removes them entirely
+#define PROFILE_HOT_PATH   1
 
 // the following are the macros for output
 // in case you want to log elsewhere
+#if DEBUG_TRACE
+#define DEBUG_PRINT(fmt, args...) SIM_TRACE("DEBUG: " fmt, ##args);
+#else
 #define DEBUG_PRINT(fmt, args...) fprintf(stderr, "DEBUG: " fmt, ##args);
-#define ERROR_PRINT(fmt, args...) fprintf(stderr, "ERROR (%s:%d): " fmt, __FILE__, __LINE__, ##args);
+#endif
+#define ERROR_PRINT(fmt, args...) (fprintf(stderr, "ERROR (%s:%d): " fmt, __FILE__, __LINE__, ##args), sim_trace_error());
 #define INFO_PRINT(fmt, args...) fprintf(stderr, fmt, ##args);
 
 #endif
@@ -0,0 +1,80 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// queuesim-generate writes a synthetic text workload, like
+// tools/make_arrivals.pl but from the generator built into queuesim
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "generator.h"
+#include "workload.h"
+
+
+static void usage(void) {
+  fprintf(stderr, "queuesim-generate spec\n");
+  fprintf(stderr, "  writes a workload to stdout, for example expexp:1:0.5:T=1000\n");
+  fprintf(stderr, "  spec is one of (see support/generator.h)\n");
+  fprintf(stderr, "    expexp:mu_arr:mu_size\n");
+  fprintf(stderr, "    exppareto:mu_arr:alpha_size\n");
+  fprintf(stderr, "    ramp:max[:staytime], stepramp:timeinc:max, sawtooth:max:freq,\n");
+  fprintf(stderr, "    sine:max:freq, exp:tau, log:rate, step:start:max (offered load)\n");
+  fprintf(stderr, "    mmpp:rates=r1,..,rn:Q=row1/../rown, onoff:rate:on:off:alpha[:sources=n]\n");
+  fprintf(stderr, "  followed by :T=secs and optionally :seed=int\n");
+  fprintf(stderr, "  and, except for expexp and exppareto, :size=mean or :alpha=a\n");
+  fprintf(stderr, "environment (as for make_arrivals.pl):\n");
+  fprintf(stderr, "  SEED=int              random number seed [def: time(0)]\n");
+  fprintf(stderr, "  APERIODIC=p:l:u       probability and priority range [def: 1:0:100]\n");
+  fprintf(stderr, "  SPORADIC=p:a:b        probability and deadline multiplier range [def: 0:2:8]\n");
+  fprintf(stderr, "  PERIODIC=p:a:b:c:d    probability, period multiplier and iteration ranges [def: 0:2:8:10:100]\n");
+  exit(-1);
+}
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    usage();
+  }
+
+  // the gen: prefix of a queuesim workload is optional here
+  char* spec = argv[1];
+  if (!strncmp(spec, SIM_WORKLOAD_GEN_PREFIX, strlen(SIM_WORKLOAD_GEN_PREFIX))) {
+    spec += strlen(SIM_WORKLOAD_GEN_PREFIX);
+  }
+
+  sim_gen_config_t config;
+  if (sim_gen_config_init(&config) || sim_gen_config_parse(&config, spec)) {
+    usage();
+  }
+  if (!config.has_seed) {
+    config.seed     = getenv("SEED") ? strtoull(getenv("SEED"), 0, 0) : (uint64_t)time(0);
+    config.has_seed = true;
+  }
+
+  sim_gen_t gen;
+  sim_gen_init(&gen, &config);
+
+  uint64_t p_count = 0, s_count = 0, a_count = 0;
+  sim_workload_cmd_t cmd;
+  while (sim_gen_next(&gen, &cmd)) {
+    sim_workload_print_cmd(stdout, &cmd);
+    p_count += cmd.type == SIM_EVENT_PERIODIC_TASK_ARRIVAL;
+    s_count += cmd.type == SIM_EVENT_SPORADIC_JOB_ARRIVAL;
+    a_count += cmd.type == SIM_EVENT_APERIODIC_JOB_ARRIVAL;
+  }
+
+  fprintf(stderr, "Generated %s with seed %lu\n", spec, config.seed);
+  fprintf(stderr, "      periodic tasks       %lu\n", p_count);
+  fprintf(stderr, "      sporadic jobs        %lu\n", s_count);
+  fprintf(stderr, "      aperiodic jobs       %lu\n", a_count);
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// queuesim-logdump converts a binary log written with
+// QUEUESIM_LOG_FORMAT=binary back to the traditional text log, which is
+// byte-for-byte what the simulation would have written, or to CSV
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "job.h"
+#include "logformat.h"
+
+
+static void usage(void) {
+  fprintf(stderr, "queuesim-logdump [text|csv] logfile.bin\n");
+  fprintf(stderr, "  converts a binary queuesim log to text (default) or CSV on stdout\n");
+  exit(-1);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3) {
+    usage();
+  }
+
+  bool csv   = false;
+  char* path = argv[argc - 1];
+  if (argc == 3) {
+    if (!strcmp(argv[1], "csv")) {
+      csv = true;
+    } else if (strcmp(argv[1], "text")) {
+      usage();
+    }
+  }
+
+  FILE* in = fopen(path, "r");
+  if (!in) {
+    fprintf(stderr, "Can't open %s\n", path);
+    exit(-1);
+  }
+
+  sim_log_header_t h;
+  if (sim_log_read_header(in, &h)) {
+    fprintf(stderr, "Can't read log header from %s\n", path);
+    exit(-1);
+  }
+
+  sim_time_t last_time = 0;
+
+  if (h.kind == SIM_LOG_QUEUELEN) {
+    sim_log_queuelen_t q;
+    if (csv) {
+      sim_log_print_queuelen_csv_header(stdout);
+    }
+    while (!sim_log_read_queuelen(in, &last_time, &q)) {
+      if (csv) {
+        sim_log_print_queuelen_csv(stdout, &q);
+      } else {
+        sim_log_print_queuelen(stdout, &q);
+      }
+    }
+  } else if (h.kind == SIM_LOG_QUEUELEN_SUMMARY) {
+    sim_log_queuelen_summary_t q;
+    if (csv) {
+      sim_log_print_queuelen_summary_csv_header(stdout);
+    }
+    while (!sim_log_read_queuelen_summary(in, &last_time, &q)) {
+      if (csv) {
+        sim_log_print_queuelen_summary_csv(stdout, &q);
+      } else {
+        sim_log_print_queuelen_summary(stdout, &q);
+      }
+    }
+  } else if (h.kind == SIM_LOG_WINDOW) {
+    sim_log_window_t w;
+    if (csv) {
+      sim_log_print_window_csv_header(stdout);
+    }
+    while (!sim_log_read_window(in, &last_time, &w)) {
+      if (csv) {
+        sim_log_print_window_csv(stdout, &w);
+      } else {
+        sim_log_print_window(stdout, &w);
+      }
+    }
+  } else {
+    sim_job_t job;
+    sim_time_t time;
+    sim_log_record_type_t type;
+    if (csv) {
+      sim_log_print_job_csv_header(stdout);
+    }
+    while (!sim_log_read_job(in, &last_time, &time, &type, &job)) {
+      if (csv) {
+        sim_log_print_job_csv(stdout, time, type, &job);
+      } else {
+        sim_log_print_job(stdout, h.kind, time, type, &job);
+      }
+    }
+  }
+
+  fclose(in);
+  return 0;
+}
@@ -32,56 +32,62 @@
 #define DEE "\e[0m"
 
 
-int main(int argc, char** argv) {
-
-  // print help output
-  if (argc < 3 || argc > 4 ) {
-    fprintf(stderr, "queuesim schedspec eventfile [singlestep]\n");
-    fprintf(stderr, "available schedulers: \n");
-    sim_sched_list(stderr);
-    fprintf(stderr, "environment:\n");
-    fprintf(stderr, "  QUEUESIM_SEED      => random number seed [def: time(0)]\n");
-    fprintf(stderr, "  QUEUESIM_QUANTUM   => scheduling quantum in seconds [def: 0.01]\n");
+// set up a simulation of eventfile, with the options from the environment
+static void setup(sim_context_t*    context,
+                  char*             schedspec,
+                  sim_time_t        quantum,
+                  sim_log_config_t* log_config,
+                  char*             eventfile) {
+  if (sim_context_init(context, schedspec, quantum, log_config)) {
+    fprintf(stderr, "Unable to initialize simulation context (does %s exist?)\n", schedspec);
     exit(-1);
   }
 
-  // get user input
-  char* schedspec = argv[1];
-  char* eventfile = argv[2];
-
-  // assume singlestepping
-  bool singlestep = (argc == 4);
-
-  // check if an environment variable defined a random seed
-  if (getenv("QUEUESIM_SEED")) {
-    srand(atoi(getenv("QUEUESIM_SEED")));
-  } else {
-    srand(time(0));
+  if (getenv("QUEUESIM_QUANTILES") && sim_context_set_quantiles(context, getenv("QUEUESIM_QUANTILES"))) {
+    fprintf(stderr, "Bad QUEUESIM_QUANTILES %s\n", getenv("QUEUESIM_QUANTILES"));
+    exit(-1);
   }
 
-  double quantum = 0.01; // 10 ms
-  if (getenv("QUEUESIM_QUANTUM")) {
-    quantum = atof(getenv("QUEUESIM_QUANTUM"));
+  double precision   = getenv("QUEUESIM_PRECISION") ? atof(getenv("QUEUESIM_PRECISION")) : 0;
+  sim_time_t maxtime = getenv("QUEUESIM_MAX_TIME") ? sim_time_from_double(atof(getenv("QUEUESIM_MAX_TIME"))) : 0;
+  uint64_t maxjobs   = getenv("QUEUESIM_MAX_JOBS") ? strtoull(getenv("QUEUESIM_MAX_JOBS"), NULL, 0) : 0;
+  sim_context_set_stop(context, precision, maxtime, maxjobs);
+
+  if (getenv("QUEUESIM_WARMUP")) {
+    if (!strcasecmp(getenv("QUEUESIM_WARMUP"), "mser5")) {
+      sim_context_set_warmup(context, true);
+    } else if (strcasecmp(getenv("QUEUESIM_WARMUP"), "off")) {
+      fprintf(stderr, "Unknown QUEUESIM_WARMUP %s (use mser5 or off)\n", getenv("QUEUESIM_WARMUP"));
+      exit(-1);
+    }
   }
 
-  // setup the simulation
-  sim_context_t context;
-  if (sim_context_init(&context, schedspec, quantum)) {
-    fprintf(stderr, "Unable to initialize simulation context (does %s exist?)\n", schedspec);
-    exit(-1);
+  if (getenv("QUEUESIM_PROFILE")) {
+    if (!strcasecmp(getenv("QUEUESIM_PROFILE"), "on")) {
+      if (sim_context_set_profile(context, true)) {
+        fprintf(stderr, "Unable to profile\n");
+        exit(-1);
+      }
+    } else if (strcasecmp(getenv("QUEUESIM_PROFILE"), "off")) {
+      fprintf(stderr, "Unknown QUEUESIM_PROFILE %s (use on or off)\n", getenv("QUEUESIM_PROFILE"));
+      exit(-1);
+    }
   }
 
-  if (sim_context_load_events(&context, eventfile)) {
+  if (sim_context_load_events(context, eventfile)) {
     fprintf(stderr, "Unable to load events from %s\n", eventfile);
     exit(-1);
   }
 
-  if (sim_context_begin(&context)) {
+  if (sim_context_begin(context)) {
     fprintf(stderr, "Unable to begin\n");
     exit(-1);
   }
+}
 
-  // run the simulation, continues until all events are completed
+// run the simulation, until all events are completed or a stop condition
+// is met, returning the number of events
+static uint64_t run(sim_context_t* context, bool singlestep) {
   uint64_t count = 0;
   while (1) {
 
@@ -89,15 +95,15 @@ int main(int argc, char** argv) {
     if (singlestep) {
       fprintf(stderr, ES "==================== Event %lu =========================================\n" EE, count);
       fprintf(stderr, EQS "======Event Queue:\n" EQE);
-      sim_event_queue_print(&context.event_queue, stderr);
+      sim_event_queue_print(&context->event_queue, stderr);
       fprintf(stderr, RQS "======Realtime Job Queue:\n" RQE);
-      sim_job_queue_print(&context.realtime_queue, stderr);
+      sim_job_queue_print(&context->realtime_queue, stderr);
       fprintf(stderr, AQS "======Aperiodic Job Queue:\n" AQE);
-      sim_job_queue_print(&context.aperiodic_queue, stderr);
+      sim_job_queue_print(&context->aperiodic_queue, stderr);
     }
 
     // get next event, and finish if there is none
-    sim_event_t* event = sim_context_get_next_event(&context);
+    sim_event_t* event = sim_context_get_next_event(context);
     if (!event) {
       break;
     }
@@ -110,7 +116,7 @@ int main(int argc, char** argv) {
     }
 
     // actually handle the event
-    sim_context_dispatch_event(&context, event);
+    sim_context_dispatch_event(context, event);
 
     // wait for user to hit enter if singlestepping
     if (singlestep) {
@@ -124,12 +130,123 @@ int main(int argc, char** argv) {
     count++;
   }
 
-  // print results
+  return count;
+}
+
+
+int main(int argc, char** argv) {
+
+  // print help output
+  if (argc < 3 || argc > 4 ) {
+    fprintf(stderr, "queuesim schedspec eventfile [singlestep]\n");
+    fprintf(stderr, "  eventfile may be - (stdin) or a FIFO to stream the workload in,\n");
+    fprintf(stderr, "  or gen:<spec> to generate one (see queuesim-generate)\n");
+    fprintf(stderr, "available schedulers: \n");
+    sim_sched_list(stderr);
+    fprintf(stderr, "environment:\n");
+    fprintf(stderr, "  QUEUESIM_SEED      => random number seed [def: time(0)]\n");
+    fprintf(stderr, "  QUEUESIM_QUANTUM   => scheduling quantum in seconds [def: 0.01]\n");
+    fprintf(stderr, "  QUEUESIM_LOG_FORMAT => text or binary logs [def: text]\n");
+    fprintf(stderr, "  QUEUESIM_LOGS      => logs to write: queuelen,events,jobs,trace, all, or none [def: all]\n");
+    fprintf(stderr, "  QUEUESIM_QUEUELEN  => queue length log: event, sample:<secs>, or summary:<secs> [def: event]\n");
+    fprintf(stderr, "  QUEUESIM_WINDOW    => write throughput, utilization, queue depth and turnaround every <secs> [def: off]\n");
+    fprintf(stderr, "  QUEUESIM_PRECISION => stop when the 95%% intervals of turnaround and slowdown are within this fraction of the mean [def: off]\n");
+    fprintf(stderr, "  QUEUESIM_MAX_TIME  => stop at this simulated time [def: off]\n");
+    fprintf(stderr, "  QUEUESIM_MAX_JOBS  => stop after this many jobs complete [def: off]\n");
+    fprintf(stderr, "  QUEUESIM_WARMUP    => mser5 to detect and discard the warm-up, or off [def: off]\n");
+    fprintf(stderr, "  QUEUESIM_TRACE     => DEBUG output: ring, ring:<records>, stderr, or off [def: ring, stderr if singlestepping]\n");
+    fprintf(stderr, "  QUEUESIM_QUANTILES => percentiles to report, comma-separated [def: " SIM_STATS_DEFAULT_QUANTILES "]\n");
+    fprintf(stderr, "  QUEUESIM_PROFILE   => on to print per-event-type hot-path cost histograms [def: off]\n");
+    fprintf(stderr, "  QUEUESIM_REPLICATIONS => run this many times and merge the statistics (logs are of the first) [def: 1]\n");
+    exit(-1);
+  }
+
+  // get user input
+  char* schedspec = argv[1];
+  char* eventfile = argv[2];
+
+  // assume singlestepping
+  bool singlestep = (argc == 4);
+  if (singlestep && !strcmp(eventfile, "-")) {
+    fprintf(stderr, "Cannot singlestep a workload read from stdin\n");
+    exit(-1);
+  }
+
+  // check if an environment variable defined a random seed
+  if (getenv("QUEUESIM_SEED")) {
+    srand(atoi(getenv("QUEUESIM_SEED")));
+  } else {
+    srand(time(0));
+  }
+
+  sim_time_t quantum = sim_time_from_double(0.01); // 10 ms
+  if (getenv("QUEUESIM_QUANTUM")) {
+    quantum = sim_time_from_double(atof(getenv("QUEUESIM_QUANTUM")));
+  }
+
+  sim_log_config_t log_config;
+  sim_log_config_init(&log_config);
+  if (getenv("QUEUESIM_LOG_FORMAT")) {
+    if (!strcasecmp(getenv("QUEUESIM_LOG_FORMAT"), "binary")) {
+      log_config.format = SIM_LOG_BINARY;
+    } else if (strcasecmp(getenv("QUEUESIM_LOG_FORMAT"), "text")) {
+      fprintf(stderr, "Unknown log format %s (use text or binary)\n", getenv("QUEUESIM_LOG_FORMAT"));
+      exit(-1);
+    }
+  }
+  if (getenv("QUEUESIM_LOGS") && sim_log_config_parse_logs(&log_config, getenv("QUEUESIM_LOGS"))) {
+    fprintf(stderr, "Bad QUEUESIM_LOGS %s\n", getenv("QUEUESIM_LOGS"));
+    exit(-1);
+  }
+  if (getenv("QUEUESIM_QUEUELEN") && sim_log_config_parse_queuelen(&log_config, getenv("QUEUESIM_QUEUELEN"))) {
+    fprintf(stderr, "Bad QUEUESIM_QUEUELEN %s\n", getenv("QUEUESIM_QUEUELEN"));
+    exit(-1);
+  }
+  if (getenv("QUEUESIM_WINDOW") && sim_log_config_parse_window(&log_config, getenv("QUEUESIM_WINDOW"))) {
+    fprintf(stderr, "Bad QUEUESIM_WINDOW %s\n", getenv("QUEUESIM_WINDOW"));
+    exit(-1);
+  }
+
+  if (singlestep) {
+    log_config.trace_mode = SIM_TRACE_STDERR;
+  }
+  if (getenv("QUEUESIM_TRACE") && sim_log_config_parse_trace(&log_config, getenv("QUEUESIM_TRACE"))) {
+    fprintf(stderr, "Bad QUEUESIM_TRACE %s\n", getenv("QUEUESIM_TRACE"));
+    exit(-1);
+  }
+
+  uint64_t replications = getenv("QUEUESIM_REPLICATIONS") ? strtoull(getenv("QUEUESIM_REPLICATIONS"), NULL, 0) : 1;
+  if (replications < 1 || (replications > 1 && (singlestep || !strcmp(eventfile, "-")))) {
+    fprintf(stderr, "Bad QUEUESIM_REPLICATIONS %s (at least 1, and only 1 when single stepping or reading stdin)\n",
+            getenv("QUEUESIM_REPLICATIONS"));
+    exit(-1);
+  }
+
+  // run the simulation
+  sim_context_t context;
+  setup(&context, schedspec, quantum, &log_config, eventfile);
+  uint64_t count = run(&context, singlestep);
   fprintf(stderr, "%lu events processed\n", count);
+
+  // run the replications, each with the logs off so they leave those of
+  // the first alone, and merge their statistics into the first's
+  sim_log_config_t replication_config = log_config;
+  replication_config.queuelen = replication_config.events = false;
+  replication_config.jobs = replication_config.trace = false;
+  replication_config.window_interval = 0;
+  for (uint64_t i = 1; i < replications; i++) {
+    sim_context_t replication;
+    setup(&replication, schedspec, quantum, &replication_config, eventfile);
+    count = run(&replication, false);
+    fprintf(stderr, "%lu events processed in replication %lu\n", count, i);
+    sim_context_merge_stats(&context, &replication);
+    sim_context_deinit(&replication);
+  }
+
+  // print results
   sim_context_print_stats(&context, stdout);
 
   // clean up and exit
   sim_context_deinit(&context);
   return 0;
 }
-
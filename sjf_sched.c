@@ -30,6 +30,7 @@
 typedef struct sched_state {
   sim_sched_t* sim;
   bool busy;
+  sim_event_t done_event;
 } sched_state_t;
 
 
@@ -40,6 +41,9 @@ static int init(void* state, sim_context_t* context) {
   // initially, nothing is scheduled
   s->busy = false;
 
+  // the single done event is reused for every job we run
+  sim_event_init_embedded(&s->done_event, SIM_EVENT_JOB_DONE);
+
   return 0;
 }
 
@@ -58,12 +62,12 @@ int find_smaller(sim_job_t* lhs, sim_job_t* rhs) {
 // Function called when an aperiodic job arrives
 static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
                                                     sim_context_t* context,
-                                                    double         current_time,
+                                                    sim_time_t     current_time,
                                                     sim_job_t*     job) {
 
   sched_state_t* s = (sched_state_t*)state;
 
-  DEBUG("Time[%lf] ARRIVAL, job %lu size %lf\n", current_time, job->id, job->size);
+  DEBUG("Time[%lf] ARRIVAL, job %lu size %lf\n", sim_time_to_double(current_time), job->id, sim_time_to_double(job->size));
 
   // add the job to the queue of jobs at the end
   int (* compare)(sim_job_t* lhs, sim_job_t* rhs);
@@ -74,18 +78,9 @@ static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
   if (!s->busy) {
     DEBUG("starting new job %lu because we are idle\n", job->id);
 
-    // create an event for when this job is done
-    sim_event_t* event = sim_event_create(current_time + job->size,
-                                          context,
-                                          SIM_EVENT_JOB_DONE,
-                                          job);
-    if (!event) {
-      ERROR("failed to allocate event\n");
-      return SIM_SCHED_REJECT;
-    }
-
-    // post the event
-    sim_event_queue_post(&context->event_queue, event);
+    // arm the done event for when this job is done
+    sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                               current_time + job->size, job);
     s->busy = true;
   }
 
@@ -96,12 +91,12 @@ static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
 // Function called when a job is finished
 static void job_done(void*          state,
                      sim_context_t* context,
-                     double         current_time,
+                     sim_time_t     current_time,
                      sim_job_t*     job) {
 
   sched_state_t* s = (sched_state_t*)state;
 
-  DEBUG("TIME[%lf] DONE, job %lu\n", current_time, job->id);
+  DEBUG("TIME[%lf] DONE, job %lu\n", sim_time_to_double(current_time), job->id);
 
   // remove the job from the job queue
   sim_job_queue_remove(&context->aperiodic_queue, job);
@@ -123,18 +118,9 @@ static void job_done(void*          state,
   }
 
   // there is a job, so let's schedule it
-  DEBUG("%lf switching to job %lu\n", current_time, next->id);
-  sim_event_t* event = sim_event_create(current_time + next->size,
-                                        context,
-                                        SIM_EVENT_JOB_DONE,
-                                        next);
-  if (!event) {
-    ERROR("failed to allocate event\n");
-    return;
-  }
-
-  // post the event
-  sim_event_queue_post(&context->event_queue, event);
+  DEBUG("%lf switching to job %lu\n", sim_time_to_double(current_time), next->id);
+  sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                             current_time + next->size, next);
   s->busy = true;
 }
 
@@ -142,7 +128,7 @@ static void job_done(void*          state,
 // Function called when a timeslice expires
 static void timer_interrupt(void*          state,
                             sim_context_t* context,
-                            double         current_time) {
+                            sim_time_t     current_time) {
   // nothing to do in this scheduler
   DEBUG("ignoring timer interrupt\n");
 }
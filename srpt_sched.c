@@ -30,7 +30,7 @@
 typedef struct sched_state {
   sim_sched_t* sim;
   bool busy;
-  sim_event_t* current_event;
+  sim_event_t done_event;
 } sched_state_t;
 
 
@@ -40,6 +40,9 @@ static int init(void* state, sim_context_t* context) {
 
   // initially, nothing is scheduled
   s->busy = false;
+
+  // the single done event is reused for every job we run
+  sim_event_init_embedded(&s->done_event, SIM_EVENT_JOB_DONE);
   return 0;
 }
 
@@ -58,52 +61,38 @@ int find_smaller_remaining(sim_job_t* lhs, sim_job_t* rhs) {
 // Function called when an aperiodic job arrives
 static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
                                                     sim_context_t* context,
-                                                    double         current_time,
+                                                    sim_time_t     current_time,
                                                     sim_job_t*     job) {
 
   sched_state_t* s = (sched_state_t*)state;
   
-  DEBUG("Time[%lf] ARRIVAL, job %lu size %lf\n", current_time, job->id, job->size);
+  DEBUG("Time[%lf] ARRIVAL, job %lu size %lf\n", sim_time_to_double(current_time), job->id, sim_time_to_double(job->size));
 
   // add the job to the queue in order of job's remaining size
   int (* compare)(sim_job_t* lhs, sim_job_t* rhs);
   compare = &find_smaller_remaining;
   if(s->busy) {
-    DEBUG("current %lu event%lu\n", s->current_event->id, s->current_event->job->id);
+    DEBUG("current %u event%lu\n", s->done_event.id, s->done_event.job->id);
     sim_job_t* cur_job = sim_job_queue_peek(&context->aperiodic_queue);
-    sim_job_set_remaining_size(cur_job, s->current_event->timestamp - current_time);
+    sim_job_set_remaining_size(cur_job, s->done_event.timestamp - current_time);
     sim_job_queue_enqueue_in_order(&context->aperiodic_queue, job, compare);
 
-    DEBUG("cur_job %lu has %lf left, job %lu has %lf left\n", s->current_event->job->id, cur_job->remaining_size, job->id, job->remaining_size);
+    DEBUG("cur_job %lu has %lf left, job %lu has %lf left\n", s->done_event.job->id, sim_time_to_double(cur_job->remaining_size), job->id, sim_time_to_double(job->remaining_size));
     if(cur_job->remaining_size > job->remaining_size) {
       DEBUG("Switching from job %lu to job %lu according to remaining size\n", cur_job->id, job->id);
-        sim_event_t* new_event = sim_event_create(current_time + job->remaining_size, context, SIM_EVENT_JOB_DONE, job);
-        if (!new_event) {
-            ERROR("failed to allocate event\n");
-            return SIM_SCHED_REJECT;
-        }
-        sim_event_queue_delete(&context->event_queue, s->current_event);
-        s->current_event = new_event;
-        sim_event_queue_post(&context->event_queue, new_event);
+        // reuse the pending done event for the new job
+        sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                                   current_time + job->remaining_size, job);
     }
   }
   // only start a new job if there is not one already running
   else {
     DEBUG("starting new job %lu because we are idle\n", job->id);
     sim_job_queue_enqueue_in_order(&context->aperiodic_queue, job, compare);
-    // create an event for when this job is done
-    sim_event_t* event = sim_event_create(current_time + job->remaining_size,
-                                          context,
-                                          SIM_EVENT_JOB_DONE,
-                                          job);
-    if (!event) {
-      ERROR("failed to allocate event\n");
-    }
-
-    s->current_event = event;
-    DEBUG("current %lu event%lu\n", s->current_event->id, s->current_event->job->id);
-    // post the event
-    sim_event_queue_post(&context->event_queue, event);
+    // arm the done event for when this job is done
+    sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                               current_time + job->remaining_size, job);
+    DEBUG("current %u event%lu\n", s->done_event.id, s->done_event.job->id);
     s->busy = true;
   }
 
@@ -114,13 +103,13 @@ static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
 // Function called when a job is finished
 static void job_done(void*          state,
                      sim_context_t* context,
-                     double         current_time,
+                     sim_time_t     current_time,
                      sim_job_t*     job) {
 
   sched_state_t* s = (sched_state_t*)state;
 
-  DEBUG("TIME[%lf] DONE, job %lu\n", current_time, job->id);
-  DEBUG("current %lu event%lu\n", s->current_event->id, s->current_event->job->id);
+  DEBUG("TIME[%lf] DONE, job %lu\n", sim_time_to_double(current_time), job->id);
+  DEBUG("current %u event%lu\n", s->done_event.id, s->done_event.job->id);
 
   // remove the job from the job queue
   sim_job_queue_remove(&context->aperiodic_queue, job);
@@ -142,28 +131,18 @@ static void job_done(void*          state,
   }
 
   // there is a job, so let's schedule it
-  DEBUG("%lf switching to job %lu\n", current_time, next->id);
-  sim_event_t* event = sim_event_create(current_time + next->remaining_size,
-                                        context,
-                                        SIM_EVENT_JOB_DONE,
-                                        next);
-  if (!event) {
-    ERROR("failed to allocate event\n");
-    return;
-  }
-
-  // post the event
-  sim_event_queue_post(&context->event_queue, event);
+  DEBUG("%lf switching to job %lu\n", sim_time_to_double(current_time), next->id);
+  sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                             current_time + next->remaining_size, next);
   s->busy = true;
-  s->current_event = event;
-  DEBUG("current %lu event%lu\n", s->current_event->id, s->current_event->job->id);
+  DEBUG("current %u event%lu\n", s->done_event.id, s->done_event.job->id);
 }
 
 
 // Function called when a timeslice expires
 static void timer_interrupt(void*          state,
                             sim_context_t* context,
-                            double         current_time) {
+                            sim_time_t     current_time) {
   // nothing to do in this scheduler
   DEBUG("ignoring timer interrupt\n");
 }
@@ -30,8 +30,8 @@
 typedef struct sched_state {
   sim_sched_t* sim;
   bool busy;
-  sim_event_t* current_event;
-  sim_event_t* current_timer;
+  sim_event_t done_event;
+  sim_event_t timer_event;
 } sched_state_t;
 
 
@@ -42,6 +42,10 @@ static int init(void* state, sim_context_t* context) {
   // initially, nothing is scheduled
   s->busy = false;
 
+  // the done and timer events are reused for every slice we run
+  sim_event_init_embedded(&s->done_event, SIM_EVENT_JOB_DONE);
+  sim_event_init_embedded(&s->timer_event, SIM_EVENT_TIMER);
+
   return 0;
 }
 
@@ -60,14 +64,14 @@ int find_smaller_dynamic(sim_job_t* lhs, sim_job_t* rhs) {
 // Function called when an aperiodic job arrives
 static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
                                                     sim_context_t* context,
-                                                    double         current_time,
+                                                    sim_time_t     current_time,
                                                     sim_job_t*     job) {
 
   sched_state_t* s = (sched_state_t*)state;
   int (* compare)(sim_job_t* lhs, sim_job_t* rhs);
   compare = &find_smaller_dynamic;
   
-  DEBUG("Time[%lf] ARRIVAL, job %lu, size %lf\n", current_time, job->id, job->size);
+  DEBUG("Time[%lf] ARRIVAL, job %lu, size %lf\n", sim_time_to_double(current_time), job->id, sim_time_to_double(job->size));
 
   // add the job to the queue of jobs at the end
   sim_job_t* cur_job = sim_job_queue_peek(&context->aperiodic_queue);
@@ -92,24 +96,11 @@ static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
   if (!s->busy) {
     DEBUG("starting new job %lu because we are idle\n", job->id);
 
-    sim_event_t* event = sim_event_create(current_time + job->remaining_size,
-                                        context,
-                                        SIM_EVENT_JOB_DONE,
-                                        job);
-    sim_event_t* timer = sim_event_create(current_time + context->quantum,
-                                        context,
-                                        SIM_EVENT_TIMER,
-                                        job);
-    if (!event || !timer) {
-      ERROR("failed to allocate event\n");
-      return SIM_SCHED_REJECT;
-    }
-
-    // post the event
-    s->current_event = event;
-    s->current_timer = timer;
-    sim_event_queue_post(&context->event_queue, event);
-    sim_event_queue_post(&context->event_queue, timer);
+    // arm the done and timer events for this slice
+    sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                               current_time + job->remaining_size, job);
+    sim_event_queue_reschedule(&context->event_queue, &s->timer_event,
+                               current_time + context->quantum, job);
     sched_state_t* s = (sched_state_t*)state;
     s->busy = true;
   }
@@ -122,13 +113,13 @@ static sim_sched_acceptance_t aperiodic_job_arrival(void*          state,
 // Function called when a job is finished
 static void job_done(void*          state,
                      sim_context_t* context,
-                     double         current_time,
+                     sim_time_t     current_time,
                      sim_job_t*     job) {
 
   sched_state_t* s = (sched_state_t*)state;
 
-  DEBUG("TIME[%lf] DONE, job %lu\n", current_time, job->id);
-  sim_event_queue_delete(&context->event_queue, s->current_timer);
+  DEBUG("TIME[%lf] DONE, job %lu\n", sim_time_to_double(current_time), job->id);
+  sim_event_queue_delete(&context->event_queue, &s->timer_event);
 
   // remove the job from the job queue
   sim_job_queue_remove(&context->aperiodic_queue, job);
@@ -149,30 +140,13 @@ static void job_done(void*          state,
   }
 
   // there is a job, so let's schedule it
-  DEBUG("%lf switching to job %lu\n", current_time, next->id);
-  sim_event_t* event = sim_event_create(current_time + next->remaining_size,
-                                        context,
-                                        SIM_EVENT_JOB_DONE,
-                                        next);
-  if (!event) {
-    ERROR("failed to allocate event\n");
-    return;
-  }
-
-  sim_event_t* timer = sim_event_create(current_time + context->quantum,
-                                        context,
-                                        SIM_EVENT_TIMER,
-                                        next);
-  if (!timer) {
-    ERROR("failed to allocate event\n");
-    return;
-  }
-  // post the event
-  sim_event_queue_post(&context->event_queue, event);
-  sim_event_queue_post(&context->event_queue, timer);
+  DEBUG("%lf switching to job %lu\n", sim_time_to_double(current_time), next->id);
+  // arm the done and timer events for this slice
+  sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                             current_time + next->remaining_size, next);
+  sim_event_queue_reschedule(&context->event_queue, &s->timer_event,
+                             current_time + context->quantum, next);
   s->busy = true;
-  s->current_event = event;
-  s->current_timer = timer;
   // We can only reschedule a new when a timeslice expires, not when a job is finished
   // The scheduler always provides a full timeslice, jobs may use less than their entire timeslice
   // We need to wait until the end of the current timeslice
@@ -183,7 +157,7 @@ static void job_done(void*          state,
 // Function called when a timeslice expires
 static void timer_interrupt(void*          state,
                             sim_context_t* context,
-                            double         current_time) {
+                            sim_time_t     current_time) {
   sched_state_t* s = (sched_state_t*)state;
   int (* compare)(sim_job_t* lhs, sim_job_t* rhs);
   compare = &find_smaller_dynamic;
@@ -204,10 +178,10 @@ static void timer_interrupt(void*          state,
         sim_job_queue_enqueue(&context->aperiodic_queue, cur_job);
       }
   
-      DEBUG("%lf job %lu expires, remaining size %lf, current dynamic priority %llu\n", current_time, cur_job->id, cur_job->remaining_size, cur_job->dynamic_priority);
+      DEBUG("%lf job %lu expires, remaining size %lf, current dynamic priority %llu\n", sim_time_to_double(current_time), cur_job->id, sim_time_to_double(cur_job->remaining_size), cur_job->dynamic_priority);
 
       // delete the "Job Done" event of the job
-      sim_event_queue_delete(&context->event_queue, s->current_event);
+      sim_event_queue_delete(&context->event_queue, &s->done_event);
   }
 
 
@@ -221,26 +195,13 @@ static void timer_interrupt(void*          state,
   }
 
   // there is a job, so let's schedule it
-  DEBUG("%lf switching to job %lu, remaining size %lf, current dynamic priority %llu\n", current_time, next->id, next->remaining_size, next->dynamic_priority);
-  sim_event_t* event = sim_event_create(current_time + next->remaining_size,
-                                        context,
-                                        SIM_EVENT_JOB_DONE,
-                                        next);
-  sim_event_t* timer = sim_event_create(current_time + context->quantum,
-                                        context,
-                                        SIM_EVENT_TIMER,
-                                        next);
-  if (!timer) {
-    ERROR("failed to allocate event\n");
-    return;
-  }
-
-  // post the event
-  sim_event_queue_post(&context->event_queue, event);
-  sim_event_queue_post(&context->event_queue, timer);
+  DEBUG("%lf switching to job %lu, remaining size %lf, current dynamic priority %llu\n", sim_time_to_double(current_time), next->id, sim_time_to_double(next->remaining_size), next->dynamic_priority);
+  // arm the done and timer events for this slice
+  sim_event_queue_reschedule(&context->event_queue, &s->done_event,
+                             current_time + next->remaining_size, next);
+  sim_event_queue_reschedule(&context->event_queue, &s->timer_event,
+                             current_time + context->quantum, next);
   s->busy = true;
-  s->current_event = event;
-  s->current_timer = timer;
 }
 
 
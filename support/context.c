@@ -6,7 +6,6 @@
  *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
  */
 
-#include <ctype.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -18,6 +17,7 @@
 #include "event.h"
 #include "eventqueue.h"
 #include "scheduler.h"
+#include "workload.h"
 
 
 // control debugging prints throughout this file
@@ -29,30 +29,144 @@
 #define ERROR(fmt, args...) ERROR_PRINT("context: " fmt, ##args)
 #define INFO(fmt, args...)  INFO_PRINT("context: " fmt, ##args)
 
+// intervals from fewer or shorter batches are too unreliable to stop on
+#define SIM_CONTEXT_STOP_MIN_BATCHES    (SIM_BATCH_MEANS_MAX / 2)
+#define SIM_CONTEXT_STOP_MIN_BATCH_SIZE 32
+
 
 /* Internal helper functions */
 
-// logs status of all queues
+// current simulated time in seconds, for logs and statistics
+static double sim_context_get_current_seconds(sim_context_t* c) {
+  return sim_time_to_double(sim_context_get_current_time(c));
+}
+
+// current status of all queues
+static void sim_context_get_queue_info(sim_context_t* c, sim_log_queuelen_t* q) {
+  q->time                = sim_context_get_current_time(c);
+  q->realtime_jobs       = c->realtime_queue.num_jobs;
+  q->realtime_total      = sim_job_queue_get_total_time(&c->realtime_queue);
+  q->realtime_remaining  = sim_job_queue_get_total_remaining_time(&c->realtime_queue);
+  q->aperiodic_jobs      = c->aperiodic_queue.num_jobs;
+  q->aperiodic_total     = sim_job_queue_get_total_time(&c->aperiodic_queue);
+  q->aperiodic_remaining = sim_job_queue_get_total_remaining_time(&c->aperiodic_queue);
+}
+
+// logs status of all queues, if the queuelen log has a record per event
+// (otherwise the queues are sampled as time advances, see dispatch)
 static void sim_context_write_queue_info(sim_context_t* c) {
-  fprintf(c->queuelen_file, "%lf %lu %lf %lf %lu %lf %lf\n",
-          sim_context_get_current_time(c),
-          c->realtime_queue.num_jobs,
-          sim_job_queue_get_total_time(&c->realtime_queue),
-          sim_job_queue_get_total_remaining_time(&c->realtime_queue),
-          c->aperiodic_queue.num_jobs,
-          sim_job_queue_get_total_time(&c->aperiodic_queue),
-          sim_job_queue_get_total_remaining_time(&c->aperiodic_queue));
-  fflush(c->queuelen_file);
+  if (!c->queuelen_log.file || c->log_config.queuelen_mode != SIM_LOG_SAMPLE_EVERY_EVENT) {
+    return;
+  }
+
+  sim_log_queuelen_t q;
+  sim_context_get_queue_info(c, &q);
+  sim_log_write_queuelen(&c->queuelen_log, &q);
+}
+
+// start the distributions of completed jobs afresh (the counts of jobs
+// cover the whole run, except for the misses, which go with their stats)
+static void sim_context_reset_stats(sim_context_t* c) {
+  c->stats_start         = sim_context_get_current_time(c);
+  c->num_periodic_misses = 0;
+  c->num_sporadic_misses = 0;
+  c->realtime_jobs_time  = 0;
+  c->aperiodic_jobs_time = 0;
+  c->realtime_size_time  = 0;
+  c->aperiodic_size_time = 0;
+  c->work_time           = 0;
+  c->busy_time           = 0;
+  sim_accumulator_init(&c->periodic_misssize);
+  sim_accumulator_init(&c->periodic_missratio);
+  sim_accumulator_init(&c->sporadic_misssize);
+  sim_accumulator_init(&c->sporadic_missratio);
+  sim_accumulator_init(&c->resptime);
+  sim_accumulator_init(&c->slowdown);
+  sim_histogram_init(&c->turnaround_hist);
+  sim_histogram_init(&c->slowdown_hist);
+  sim_histogram_init(&c->periodic_misssize_hist);
+  sim_histogram_init(&c->sporadic_misssize_hist);
+  sim_batch_means_init(&c->turnaround_batches);
+  sim_batch_means_init(&c->slowdown_batches);
+  for (int i = 0; i < SIM_STATS_PRIORITY_CLASSES; i++) {
+    sim_class_stats_init(&c->priority_class[i]);
+  }
+  for (int i = 0; i < SIM_STATS_SIZE_CLASSES; i++) {
+    sim_class_stats_init(&c->size_class[i]);
+  }
+}
+
+// the queues have been as they are since stats_last, account for them
+// up to time
+static void sim_context_account_time(sim_context_t* c, sim_time_t time) {
+  double dt = time - c->stats_last;
+  if (dt <= 0) {
+    return;
+  }
+
+  sim_job_queue_t* rq = &c->realtime_queue;
+  sim_job_queue_t* aq = &c->aperiodic_queue;
+  bool busy           = rq->num_jobs || aq->num_jobs;
+  c->realtime_jobs_time  += rq->num_jobs * dt;
+  c->aperiodic_jobs_time += aq->num_jobs * dt;
+  c->realtime_size_time  += sim_time_to_double(rq->total_size) * dt;
+  c->aperiodic_size_time += sim_time_to_double(aq->total_size) * dt;
+
+  // the work falls linearly while there are jobs, until it runs out, and
+  // an empty system has none left (whatever rounding says)
+  if (busy) {
+    sim_time_t served = c->work < time - c->stats_last ? c->work : time - c->stats_last;
+    c->work_time += (sim_time_to_double(c->work) - sim_time_to_double(served) / 2) * served;
+    c->work      -= served;
+    c->busy_time += time - c->stats_last;
+  } else {
+    c->work = 0;
+  }
+  c->stats_last = time;
+}
+
+// point this thread's trace points and probes at this context, at each
+// entry point that may run scheduler or support code
+static inline void sim_context_enter(sim_context_t* c) {
+  sim_trace_enter(&c->trace);
+  sim_profile_active = c->profile.hist ? &c->profile : NULL;
+}
+
+// close whichever logs are open, and stop the log writer
+static void sim_context_close_logs(sim_context_t* c) {
+  sim_log_sink_close(&c->queuelen_log);
+  sim_log_sink_close(&c->event_log);
+  sim_log_sink_close(&c->job_log);
+  sim_log_sink_close(&c->window_log);
+  sim_log_writer_deinit(&c->log_writer);
 }
 
 
 /* Public functions */
 
-int sim_context_init(sim_context_t* context, char* sched_name, double quantum) {
+int sim_context_init(sim_context_t*    context,
+                     char*             sched_name,
+                     sim_time_t        quantum,
+                     sim_log_config_t* log_config) {
 
   // intialize simulation state
   memset(context, 0, sizeof(*context));
   context->quantum = quantum;
+  sim_context_set_quantiles(context, SIM_STATS_DEFAULT_QUANTILES);
+  sim_context_reset_stats(context);
+  if (log_config) {
+    context->log_config = *log_config;
+  } else {
+    sim_log_config_init(&context->log_config);
+  }
+
+  // start recording DEBUG() statements
+  if (sim_trace_init(&context->trace, context->log_config.trace_mode,
+                     context->log_config.trace_size, &context->event_queue.curtime)) {
+    ERROR("failed to allocate trace\n");
+    return -1;
+  }
+  sim_profile_init(&context->profile, false);
 
   // connect to the user-selected scheduler
   if (!(context->scheduler = sim_sched_find(sched_name))) {
@@ -61,18 +175,47 @@ int sim_context_init(sim_context_t* context, char* sched_name, double quantum) {
   }
 
   // open log files
-  if (!(context->queuelen_file = fopen("logs/queuesim.queuelen.out", "w"))) {
+  if (sim_log_writer_init(&context->log_writer)) {
+    ERROR("failed to start log writer\n");
+    return -1;
+  }
+  sim_log_config_t* lc = &context->log_config;
+  bool binary = lc->format == SIM_LOG_BINARY;
+  if (lc->queuelen &&
+      sim_log_sink_open(&context->queuelen_log, &context->log_writer,
+                        binary ? "logs/queuesim.queuelen.bin" : "logs/queuesim.queuelen.out",
+                        lc->queuelen_mode == SIM_LOG_SAMPLE_SUMMARY ? SIM_LOG_QUEUELEN_SUMMARY : SIM_LOG_QUEUELEN,
+                        lc->format)) {
     ERROR("failed to open queue length file\n");
+    sim_context_close_logs(context);
     return -1;
   }
-  if (!(context->log_file = fopen("logs/queuesim.log.out", "w"))) {
+  if (lc->events &&
+      sim_log_sink_open(&context->event_log, &context->log_writer,
+                        binary ? "logs/queuesim.log.bin" : "logs/queuesim.log.out",
+                        SIM_LOG_EVENTS, lc->format)) {
     ERROR("failed to open log file\n");
+    sim_context_close_logs(context);
     return -1;
   }
-  if (!(context->job_file = fopen("logs/queuesim.job.out", "w"))) {
+  if (lc->jobs &&
+      sim_log_sink_open(&context->job_log, &context->log_writer,
+                        binary ? "logs/queuesim.job.bin" : "logs/queuesim.job.out",
+                        SIM_LOG_JOBS, lc->format)) {
     ERROR("failed to open job file\n");
+    sim_context_close_logs(context);
     return -1;
   }
+  sim_log_sampler_init(&context->queuelen_sampler, lc->queuelen_mode, lc->queuelen_interval);
+  if (lc->window_interval &&
+      sim_log_sink_open(&context->window_log, &context->log_writer,
+                        binary ? "logs/queuesim.window.bin" : "logs/queuesim.window.out",
+                        SIM_LOG_WINDOW, lc->format)) {
+    ERROR("failed to open window file\n");
+    sim_context_close_logs(context);
+    return -1;
+  }
+  sim_log_windower_init(&context->windower, lc->window_interval);
 
   // initialize the queues
   sim_event_queue_init(&context->event_queue);
@@ -83,244 +226,290 @@ int sim_context_init(sim_context_t* context, char* sched_name, double quantum) {
 }
 
 void sim_context_deinit(sim_context_t* c) {
-  fclose(c->queuelen_file);
-  fclose(c->log_file);
-  fclose(c->job_file);
-}
+  sim_context_enter(c);
 
-int sim_context_load_events(sim_context_t* context, char* filename) {
-
-  FILE* in = fopen(filename, "r");
-  if (!in) {
-    ERROR("Can't read events from %s\n", filename);
-    return -1;
+  if (c->queuelen_log.file && c->log_config.queuelen_mode != SIM_LOG_SAMPLE_EVERY_EVENT) {
+    sim_log_queuelen_t q;
+    sim_context_get_queue_info(c, &q);
+    sim_log_sampler_finish(&c->queuelen_sampler, &c->queuelen_log, &q, q.time);
+  }
+  if (c->window_log.file) {
+    sim_log_queuelen_t q;
+    sim_context_get_queue_info(c, &q);
+    sim_log_windower_finish(&c->windower, &c->window_log, &q, q.time);
   }
 
-  // read in events from file
-  char b[1024];
-  char cmd[1024];
-  while (!feof(in)) {
-    char* buf = b;
-    sim_event_t* event = NULL;
-    sim_job_t* job     = NULL;
-
-    // read in line from file
-    if (!fgets(buf, 1024, in)) {
-      break;
-    }
-    if (strlen(buf) == 0) {
-      continue;
-    }
-
-    // skip over spaces
-    while (isspace(*buf)) {
-      buf++;
-    }
-    if (*buf == 0) {
-      continue;
+  // keep the last DEBUG() statements of the run
+  if (c->log_config.trace && c->trace.mode == SIM_TRACE_RING && c->trace.head) {
+    FILE* f = fopen("logs/queuesim.trace.out", "w");
+    if (f) {
+      sim_trace_dump(&c->trace, f);
+      fclose(f);
     }
+  }
+  sim_trace_deinit(&c->trace);
+  sim_profile_deinit(&c->profile);
+  free(c->warmup_log);
 
-    // skip over comments
-    if (toupper(buf[0]) == '#') {
-      continue;
-    }
+  sim_workload_source_close(c->workload_source);
 
-    // read in command from the line
-    // for each type of command:
-    //  * read further arguments
-    //  * create job if needed
-    //  * create an event and add it to queue
-    double timestamp = 0;
-    sscanf(buf, "%lf %s", &timestamp, cmd);
+  sim_context_close_logs(c);
+}
 
-    if (!strcasecmp(cmd, "APERIODIC_JOB_ARRIVAL")) {
-      double size       = 0;
-      uint64_t priority = 0;
-      sscanf(buf, "%lf %s %lf %lu", &timestamp, cmd, &size, &priority);
+// create the job and event for a workload command, without posting it
+static sim_event_t* sim_context_create_command_event(sim_context_t* context, sim_workload_cmd_t* cmd) {
+  sim_event_t* event = NULL;
+  sim_job_t* job     = NULL;
 
+  // for each type of command:
+  //  * create job if needed
+  //  * create an event for it
+  switch (cmd->type) {
+    case SIM_EVENT_APERIODIC_JOB_ARRIVAL:
       if (!(job = sim_job_create(SIM_JOB_APERIODIC,
-                                 timestamp,
-                                 size,
-                                 size,
-                                 priority,
+                                 cmd->time,
+                                 cmd->size,
+                                 cmd->size,
+                                 cmd->priority,
                                  0,
                                  0,
                                  1,
                                  0))) {
         ERROR("failed to allocate job\n");
-        return -1;
+        return NULL;
       }
+      break;
 
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_APERIODIC_JOB_ARRIVAL,
-                                     job))) {
-        ERROR("failed to allocate event\n");
-        return -1;
-      }
-
-      sim_event_queue_post(&context->event_queue, event);
-
-      continue;
-    }
-
-    if (!strcasecmp(cmd, "SPORADIC_JOB_ARRIVAL")) {
-      double size     = 0;
-      double deadline = 0;
-      sscanf(buf, "%lf %s %lf %lf", &timestamp, cmd, &size, &deadline);
-
+    case SIM_EVENT_SPORADIC_JOB_ARRIVAL:
       if (!(job = sim_job_create(SIM_JOB_SPORADIC,
-                                 timestamp,
-                                 size,
-                                 size,
+                                 cmd->time,
+                                 cmd->size,
+                                 cmd->size,
                                  0,
                                  0,
                                  0,
                                  1,
-                                 deadline))) {
+                                 cmd->deadline))) {
         ERROR("failed to allocate job\n");
-        return -1;
-      }
-
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_SPORADIC_JOB_ARRIVAL,
-                                     job))) {
-        ERROR("failed to allocate event\n");
-        return -1;
+        return NULL;
       }
+      break;
 
-      sim_event_queue_post(&context->event_queue, event);
-
-      continue;
-    }
-
-    if (!strcasecmp(cmd, "PERIODIC_TASK_ARRIVAL")) {
-      double deadline = 0;
-      double size     = 0;
-      int numiters    = 0;
-      sscanf(buf, "%lf %s %lf %lf %d", &timestamp, cmd, &deadline, &size, &numiters);
-
+    case SIM_EVENT_PERIODIC_TASK_ARRIVAL:
       if (!(job = sim_job_create(SIM_JOB_PERIODIC,
-                                 timestamp,
-                                 size,
-                                 size,
+                                 cmd->time,
+                                 cmd->size,
+                                 cmd->size,
                                  0,
                                  0,
-                                 deadline,
-                                 numiters,
-                                 timestamp + deadline))) {
+                                 cmd->period,
+                                 cmd->numiters,
+                                 cmd->time + cmd->period))) {
         ERROR("failed to allocate job\n");
-        return -1;
+        return NULL;
       }
+      break;
 
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_PERIODIC_TASK_ARRIVAL,
-                                     job))) {
-        ERROR("failed to allocate event\n");
-        return -1;
-      }
-
-      sim_event_queue_post(&context->event_queue, event);
-
-      continue;
-    }
-
-    if (!strcasecmp(cmd, "PRINT_ALL")) {
-      sscanf(buf, "%lf %s", &timestamp, cmd);
+    case SIM_EVENT_PRINT_ALL:
+    case SIM_EVENT_PRINT_STATS:
+    case SIM_EVENT_PRINT_JOB_QUEUES:
+    case SIM_EVENT_PRINT_EVENT_QUEUE:
+    case SIM_EVENT_DISPLAY_QUEUE_DEPTHS:
+    case SIM_EVENT_DUMP_TRACE:
+      break;
 
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_PRINT_ALL,
-                                     NULL))) {
-        ERROR("failed to allocate event\n");
-        return -1;
-      }
+    default:
+      ERROR("command cannot be added to a workload\n");
+      return NULL;
+  }
 
-      sim_event_queue_post(&context->event_queue, event);
+  if (!(event = sim_event_create(cmd->time, cmd->type, job))) {
+    ERROR("failed to allocate event\n");
+    return NULL;
+  }
 
-      continue;
-    }
+  // a periodic task keeps this event and re-arms it every period
+  if (cmd->type == SIM_EVENT_PERIODIC_TASK_ARRIVAL) {
+    sim_job_attach_arrival_event(job, event);
+  }
 
-    if (!strcasecmp(cmd, "PRINT_STATS")) {
-      sscanf(buf, "%lf %s", &timestamp, cmd);
+  return event;
+}
 
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_PRINT_STATS,
-                                     NULL))) {
-        ERROR("failed to allocate event\n");
-        return -1;
-      }
+int sim_context_add_command(sim_context_t* context, sim_workload_cmd_t* cmd) {
+  sim_context_enter(context);
+  sim_event_t* event = sim_context_create_command_event(context, cmd);
+  if (!event) {
+    return -1;
+  }
 
-      sim_event_queue_post(&context->event_queue, event);
+  sim_event_queue_post(&context->event_queue, event);
+  return 0;
+}
 
-      continue;
+int sim_context_load_events(sim_context_t* context, char* filename) {
+  sim_context_enter(context);
+  if (sim_workload_is_source(filename)) {
+    if (!(context->workload_source = sim_workload_source_open(filename))) {
+      ERROR("Can't read events from %s\n", filename);
+      return -1;
     }
+    return 0;
+  }
 
-    if (!strcasecmp(cmd, "PRINT_JOB_QUEUES")) {
-      sscanf(buf, "%lf %s", &timestamp, cmd);
+  if (sim_workload_load(context, filename)) {
+    ERROR("Can't read events from %s\n", filename);
+    return -1;
+  }
+  return 0;
+}
 
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_PRINT_JOB_QUEUES,
-                                     NULL))) {
-        ERROR("failed to allocate event\n");
-        return -1;
-      }
+int sim_context_begin(sim_context_t* context) {
+  sim_context_enter(context);
+  return sim_sched_init(context->scheduler, context);
+}
 
-      sim_event_queue_post(&context->event_queue, event);
+void sim_context_set_stop(sim_context_t* c, double precision, sim_time_t time, uint64_t jobs) {
+  c->stop_precision = precision;
+  c->stop_time      = time;
+  c->stop_jobs      = jobs;
+}
 
-      continue;
-    }
+void sim_context_set_warmup(sim_context_t* c, bool warmup) {
+  c->warmup = warmup;
+  sim_mser_init(&c->warmup_mser);
+  free(c->warmup_log);
+  c->warmup_log      = NULL;
+  c->warmup_log_len  = 0;
+  c->warmup_log_size = 0;
+  c->warmup_log_full = false;
+}
 
-    if (!strcasecmp(cmd, "PRINT_EVENT_QUEUE")) {
-      sscanf(buf, "%lf %s", &timestamp, cmd);
+int sim_context_set_profile(sim_context_t* c, bool profile) {
+  sim_profile_deinit(&c->profile);
+  return sim_profile_init(&c->profile, profile);
+}
 
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_PRINT_EVENT_QUEUE,
-                                     NULL))) {
-        ERROR("failed to allocate event\n");
-        return -1;
-      }
+int sim_context_set_quantiles(sim_context_t* c, const char* percentiles) {
+  int n = sim_stats_parse_quantiles(percentiles, c->quantiles, SIM_STATS_MAX_QUANTILES);
+  if (n < 0) {
+    ERROR("bad quantiles %s\n", percentiles);
+    return -1;
+  }
+  c->num_quantiles = n;
+  return 0;
+}
 
-      sim_event_queue_post(&context->event_queue, event);
+void sim_context_merge_stats(sim_context_t* dst, sim_context_t* src) {
+  dst->num_merged += 1 + src->num_merged;
 
-      continue;
-    }
+  dst->warmup_done       = dst->warmup_done && src->warmup_done;
+  dst->warmup_jobs      += src->warmup_jobs;
+  dst->warmup_discarded += src->warmup_discarded;
+  if (!dst->stop_reason) {
+    dst->stop_reason = src->stop_reason;
+  }
 
-    if (!strcasecmp(cmd, "DISPLAY_QUEUE_DEPTHS")) {
-      sscanf(buf, "%lf %s", &timestamp, cmd);
+  dst->num_jobs_done              += src->num_jobs_done;
+  dst->num_periodic_tasks         += src->num_periodic_tasks;
+  dst->num_periodic_tasksrejected += src->num_periodic_tasksrejected;
+  dst->num_periodic_jobs          += src->num_periodic_jobs;
+  dst->num_periodic_misses        += src->num_periodic_misses;
+  sim_accumulator_merge(&dst->periodic_misssize, &src->periodic_misssize);
+  sim_accumulator_merge(&dst->periodic_missratio, &src->periodic_missratio);
+
+  dst->num_sporadic_jobs         += src->num_sporadic_jobs;
+  dst->num_sporadic_jobsrejected += src->num_sporadic_jobsrejected;
+  dst->num_sporadic_misses       += src->num_sporadic_misses;
+  sim_accumulator_merge(&dst->sporadic_misssize, &src->sporadic_misssize);
+  sim_accumulator_merge(&dst->sporadic_missratio, &src->sporadic_missratio);
+
+  dst->num_aperiodic += src->num_aperiodic;
+  sim_accumulator_merge(&dst->resptime, &src->resptime);
+  sim_accumulator_merge(&dst->slowdown, &src->slowdown);
+
+  dst->num_timer_interrupts += src->num_timer_interrupts;
+
+  // the time-weighted state of the queues covers both runs' time
+  dst->merged_time         += src->stats_last - src->stats_start + src->merged_time;
+  dst->realtime_jobs_time  += src->realtime_jobs_time;
+  dst->aperiodic_jobs_time += src->aperiodic_jobs_time;
+  dst->realtime_size_time  += src->realtime_size_time;
+  dst->aperiodic_size_time += src->aperiodic_size_time;
+  dst->work_time           += src->work_time;
+  dst->busy_time           += src->busy_time;
+
+  sim_histogram_merge(&dst->turnaround_hist, &src->turnaround_hist);
+  sim_histogram_merge(&dst->slowdown_hist, &src->slowdown_hist);
+  sim_histogram_merge(&dst->periodic_misssize_hist, &src->periodic_misssize_hist);
+  sim_histogram_merge(&dst->sporadic_misssize_hist, &src->sporadic_misssize_hist);
+
+  sim_batch_means_merge(&dst->turnaround_batches, &src->turnaround_batches);
+  sim_batch_means_merge(&dst->slowdown_batches, &src->slowdown_batches);
+
+  for (int i = 0; i < SIM_STATS_PRIORITY_CLASSES; i++) {
+    sim_class_stats_merge(&dst->priority_class[i], &src->priority_class[i]);
+  }
+  for (int i = 0; i < SIM_STATS_SIZE_CLASSES; i++) {
+    sim_class_stats_merge(&dst->size_class[i], &src->size_class[i]);
+  }
 
-      if (!(event = sim_event_create(timestamp,
-                                     context,
-                                     SIM_EVENT_DISPLAY_QUEUE_DEPTHS,
-                                     NULL))) {
-        ERROR("failed to allocate event\n");
-        return -1;
-      }
+  sim_profile_merge(&dst->profile, &src->profile);
+}
 
-      sim_event_queue_post(&context->event_queue, event);
+// print the configured quantiles of a distribution, as "name pNN:" lines
+static void sim_context_print_quantiles(sim_context_t* c, FILE* f, char* name, sim_histogram_t* h) {
+  for (int i = 0; i < c->num_quantiles; i++) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s p%g:", name, c->quantiles[i] * 100);
+    fprintf(f, "%-40s%lf\n", label, sim_histogram_quantile(h, c->quantiles[i]));
+  }
+}
 
+// print a table of the classes that have jobs, named by name_fn
+static void sim_context_print_classes(FILE*              f,
+                                      char*              title,
+                                      sim_class_stats_t* classes,
+                                      int                num_classes,
+                                      void (*name_fn)(int, char*, int)) {
+  fprintf(f, "%-20s%10s%18s%18s%18s%18s\n", title, "jobs",
+          "avg turnaround", "stddev turnaround", "avg slowdown", "stddev slowdown");
+  for (int i = 0; i < num_classes; i++) {
+    sim_class_stats_t* cls = &classes[i];
+    if (!cls->turnaround.count) {
       continue;
     }
-
+    char name[32];
+    name_fn(i, name, sizeof(name));
+    fprintf(f, "%-20s%10lu%18lf%18lf%18lf%18lf\n", name, cls->turnaround.count,
+            sim_accumulator_mean(&cls->turnaround),
+            sim_accumulator_stddev(&cls->turnaround),
+            sim_accumulator_mean(&cls->slowdown),
+            sim_accumulator_stddev(&cls->slowdown));
   }
-
-  // close workload file
-  fclose(in);
-  return 0;
-}
-
-int sim_context_begin(sim_context_t* context) {
-  return sim_sched_init(context->scheduler, context);
 }
 
 void sim_context_print_stats(sim_context_t* c, FILE* f) {
   fprintf(f, "--------------------------------------------------------------------------------\n");
-  fprintf(f, "Statistics for time %lf\n\n", sim_context_get_current_time(c));
+  fprintf(f, "Statistics for time %lf\n\n", sim_context_get_current_seconds(c));
+
+  if (c->num_merged) {
+    fprintf(f, "runs merged:                            %lu\n\n", c->num_merged + 1);
+  }
+  if (c->stop_reason) {
+    fprintf(f, "stopped early at:                       %s\n\n", c->stop_reason);
+  }
+  if (c->warmup && c->warmup_done && c->num_merged) {
+    fprintf(f, "warm-up (MSER-5):                       %lu jobs in all\n", c->warmup_jobs);
+    fprintf(f, "statistics discarded:                   %lu jobs in all\n\n", c->warmup_discarded);
+  } else if (c->warmup && c->warmup_done) {
+    fprintf(f, "warm-up (MSER-5):                       %lu jobs\n", c->warmup_jobs);
+    fprintf(f, "statistics discarded:                   %lu jobs, at %lf\n\n",
+            c->warmup_discarded, sim_time_to_double(c->warmup_time));
+  } else if (c->warmup) {
+    fprintf(f, "warm-up (MSER-5):                       not detected%s\n\n",
+            c->num_merged ? " in every run" : "");
+  }
 
   fprintf(f, "number of periodic tasks:               %lu\n", c->num_periodic_tasks);
   fprintf(f, "number of sporadic jobs:                %lu\n", c->num_sporadic_jobs);
@@ -332,54 +521,68 @@ void sim_context_print_stats(sim_context_t* c, FILE* f) {
     fprintf(f, "number of rejected periodic tasks:      %lu\n", c->num_periodic_tasksrejected);
     fprintf(f, "number of periodic jobs:                %lu\n", c->num_periodic_jobs);
     fprintf(f, "number of missing periodic jobs:        %lu\n", c->num_periodic_misses);
-    fprintf(f, "average miss size:                      %lf\n",
-            c->num_periodic_misses == 0 ? 0 : (c->sum_periodic_misssize / c->num_periodic_misses));
-    fprintf(f, "stddev miss size:                       %lf\n",
-            sqrt((c->num_periodic_misses <
-                  2 ? 0 : (c->sum2_periodic_misssize -
-                           (c->sum_periodic_misssize * c->sum_periodic_misssize / c->num_periodic_misses)) /
-                  (c->num_periodic_misses - 1))));
-    fprintf(f, "average miss ratio:                     %lf\n",
-            c->num_periodic_misses == 0 ? 0 : (c->sum_periodic_missratio / c->num_periodic_misses));
-    fprintf(f, "stddev miss ratio:                      %lf\n\n",
-            sqrt((c->num_periodic_misses <
-                  2 ? 0 : (c->sum2_periodic_missratio -
-                           (c->sum_periodic_missratio * c->sum_periodic_missratio / c->num_periodic_misses)) /
-                  (c->num_periodic_misses - 1))));
+    fprintf(f, "average miss size:                      %lf\n", sim_accumulator_mean(&c->periodic_misssize));
+    fprintf(f, "stddev miss size:                       %lf\n", sim_accumulator_stddev(&c->periodic_misssize));
+    sim_context_print_quantiles(c, f, "miss size", &c->periodic_misssize_hist);
+    fprintf(f, "average miss ratio:                     %lf\n", sim_accumulator_mean(&c->periodic_missratio));
+    fprintf(f, "stddev miss ratio:                      %lf\n\n", sim_accumulator_stddev(&c->periodic_missratio));
   }
 
   if (c->num_sporadic_jobs != 0) {
     fprintf(f, "number of rejected sporadic jobs:       %lu\n", c->num_sporadic_jobsrejected);
     fprintf(f, "number of missing sporadic jobs:        %lu\n", c->num_sporadic_misses);
-    fprintf(f, "average miss size:                      %lf\n",
-            c->num_sporadic_misses == 0 ? 0 : (c->sum_sporadic_misssize / c->num_sporadic_misses));
-    fprintf(f, "stddev miss size:                       %lf\n",
-            sqrt((c->num_sporadic_misses <
-                  2 ? 0 : (c->sum2_sporadic_misssize -
-                           (c->sum_sporadic_misssize * c->sum_sporadic_misssize / c->num_sporadic_misses)) /
-                  (c->num_sporadic_misses - 1))));
-    fprintf(f, "average miss ratio:                     %lf\n",
-            c->num_sporadic_misses == 0 ? 0 : (c->sum_sporadic_missratio / c->num_sporadic_misses));
-    fprintf(f, "stddev miss size:                       %lf\n\n",
-            sqrt((c->num_sporadic_misses <
-                  2 ? 0 : (c->sum2_sporadic_missratio -
-                           (c->sum_sporadic_missratio * c->sum_sporadic_missratio / c->num_sporadic_misses)) /
-                  (c->num_sporadic_misses - 1))));
+    fprintf(f, "average miss size:                      %lf\n", sim_accumulator_mean(&c->sporadic_misssize));
+    fprintf(f, "stddev miss size:                       %lf\n", sim_accumulator_stddev(&c->sporadic_misssize));
+    sim_context_print_quantiles(c, f, "miss size", &c->sporadic_misssize_hist);
+    fprintf(f, "average miss ratio:                     %lf\n", sim_accumulator_mean(&c->sporadic_missratio));
+    fprintf(f, "stddev miss size:                       %lf\n\n", sim_accumulator_stddev(&c->sporadic_missratio));
   }
 
   if (c->num_aperiodic != 0) {
-    fprintf(f, "average turnaround time:                %lf\n",
-            c->num_aperiodic == 0 ? 0 : (c->sum_resptime / c->num_aperiodic));
-    fprintf(f, "stddev turnaround time:                 %lf\n",
-            sqrt((c->num_aperiodic <
-                  2 ? 0 : (c->sum2_resptime - (c->sum_resptime * c->sum_resptime / c->num_aperiodic)) /
-                  (c->num_aperiodic - 1))));
-    fprintf(f, "average slowdown:                       %lf\n",
-            c->num_aperiodic == 0 ? 0 : (c->sum_slowdown / c->num_aperiodic));
-    fprintf(f, "stddev slowdown:                        %lf\n",
-            sqrt((c->num_aperiodic <
-                  2 ? 0 : (c->sum2_slowdown - (c->sum_slowdown * c->sum_slowdown / c->num_aperiodic)) /
-                  (c->num_aperiodic - 1))));
+    fprintf(f, "average turnaround time:                %lf\n", sim_accumulator_mean(&c->resptime));
+    fprintf(f, "stddev turnaround time:                 %lf\n", sim_accumulator_stddev(&c->resptime));
+    sim_context_print_quantiles(c, f, "turnaround time", &c->turnaround_hist);
+    fprintf(f, "average slowdown:                       %lf\n", sim_accumulator_mean(&c->slowdown));
+    fprintf(f, "stddev slowdown:                        %lf\n", sim_accumulator_stddev(&c->slowdown));
+    sim_context_print_quantiles(c, f, "slowdown", &c->slowdown_hist);
+    fprintf(f, "batch means:                            %d batches of %lu jobs\n",
+            c->turnaround_batches.num_batches, c->turnaround_batches.batch_size);
+    fprintf(f, "turnaround time 95%% CI half-width:      %lf\n",
+            sim_batch_means_halfwidth(&c->turnaround_batches));
+    fprintf(f, "slowdown 95%% CI half-width:             %lf\n",
+            sim_batch_means_halfwidth(&c->slowdown_batches));
+    fprintf(f, "\n");
+    sim_context_print_classes(f, "priority", c->priority_class,
+                              SIM_STATS_PRIORITY_CLASSES, sim_stats_priority_class_name);
+    fprintf(f, "\n");
+    sim_context_print_classes(f, "size (secs)", c->size_class,
+                              SIM_STATS_SIZE_CLASSES, sim_stats_size_class_name);
+  }
+
+  // Little's law: mean jobs in system = throughput x mean turnaround
+  double elapsed = c->stats_last - c->stats_start + c->merged_time;
+  if (elapsed > 0) {
+    double aperiodic_jobs = c->aperiodic_jobs_time / elapsed;
+    double throughput     = c->resptime.count / sim_time_to_double(elapsed);
+    double little         = throughput * sim_accumulator_mean(&c->resptime);
+
+    fprintf(f, "\n");
+    fprintf(f, "mean realtime jobs in system:           %lf\n", c->realtime_jobs_time / elapsed);
+    fprintf(f, "mean aperiodic jobs in system:          %lf\n", aperiodic_jobs);
+    fprintf(f, "mean total size of realtime jobs:       %lf\n", c->realtime_size_time / elapsed);
+    fprintf(f, "mean total size of aperiodic jobs:      %lf\n", c->aperiodic_size_time / elapsed);
+    fprintf(f, "mean unfinished work in system:         %lf\n", c->work_time / elapsed);
+    fprintf(f, "utilization:                            %lf\n", c->busy_time / elapsed);
+    if (c->num_aperiodic != 0) {
+      fprintf(f, "aperiodic throughput:                   %lf\n", throughput);
+      fprintf(f, "throughput x mean turnaround:           %lf\n", little);
+      fprintf(f, "little's law relative error:            %lf\n",
+              aperiodic_jobs > 0 ? fabs(little - aperiodic_jobs) / aperiodic_jobs : 0);
+    }
+  }
+  if (c->profile.hist) {
+    fprintf(f, "\n");
+    sim_profile_print(&c->profile, f);
   }
   fprintf(f, "--------------------------------------------------------------------------------\n");
 }
@@ -403,76 +606,204 @@ void sim_context_print_all(sim_context_t* c, FILE* f) {
 }
 
 void sim_context_display_queue_depths(sim_context_t* context) {
+  if (!context->log_config.queuelen) {
+    ERROR("cannot display queue depths without the queue length log\n");
+    return;
+  }
+  if (context->log_config.format != SIM_LOG_TEXT) {
+    ERROR("cannot display queue depths from binary logs (convert them with queuesim-logdump)\n");
+    return;
+  }
+
+  // the plot reads the queue length log, so it must be complete up to now
+  sim_log_writer_sync(&context->log_writer);
   system("./tools/plot_show.pl");
 }
 
+void sim_context_dump_trace(sim_context_t* context, FILE* f) {
+  sim_trace_dump(&context->trace, f);
+}
+
+// is the batch means interval around the mean within the target precision?
+static bool sim_context_precise(sim_context_t* c, sim_batch_means_t* b) {
+  if (b->num_batches < SIM_CONTEXT_STOP_MIN_BATCHES || b->batch_size < SIM_CONTEXT_STOP_MIN_BATCH_SIZE) {
+    return false;
+  }
+  return sim_batch_means_halfwidth(b) <= c->stop_precision * fabs(sim_batch_means_mean(b));
+}
+
+// add a completed aperiodic job to the statistics, returning 1 if it
+// completed a batch
+static int sim_context_add_aperiodic(sim_context_t* c, double turnaround, double slowdown,
+                                     uint64_t priority, double size) {
+  sim_accumulator_add(&c->resptime, turnaround);
+  sim_accumulator_add(&c->slowdown, slowdown);
+  sim_histogram_add(&c->turnaround_hist, turnaround);
+  sim_histogram_add(&c->slowdown_hist, slowdown);
+  sim_class_stats_add(&c->priority_class[sim_stats_priority_class(priority)], turnaround, slowdown);
+  sim_class_stats_add(&c->size_class[sim_stats_size_class(size)], turnaround, slowdown);
+
+  int batch = sim_batch_means_add(&c->turnaround_batches, turnaround);
+  sim_batch_means_add(&c->slowdown_batches, slowdown);
+  return batch;
+}
+
+// add a realtime job that missed its deadline to the statistics
+static void sim_context_add_miss(sim_context_t* c, sim_job_type_t type, double misssize, double missratio) {
+  if (type == SIM_JOB_SPORADIC) {
+    c->num_sporadic_misses++;
+    sim_accumulator_add(&c->sporadic_misssize, misssize);
+    sim_accumulator_add(&c->sporadic_missratio, missratio);
+    sim_histogram_add(&c->sporadic_misssize_hist, misssize);
+  } else {
+    c->num_periodic_misses++;
+    sim_accumulator_add(&c->periodic_misssize, misssize);
+    sim_accumulator_add(&c->periodic_missratio, missratio);
+    sim_histogram_add(&c->periodic_misssize_hist, misssize);
+  }
+}
+
+// keep a completion until the warm-up is detected, giving up on keeping
+// any once there are too many
+static void sim_context_log_warmup(sim_context_t* c, sim_job_t* job, double value, double ratio) {
+  if (c->warmup_log_full) {
+    return;
+  }
+  if (c->warmup_log_len == c->warmup_log_size) {
+    uint64_t size = c->warmup_log_size ? 2 * c->warmup_log_size : 1024;
+    sim_warmup_record_t* log = NULL;
+    if (size > SIM_CONTEXT_WARMUP_LOG_MAX ||
+        !(log = realloc(c->warmup_log, size * sizeof(*log)))) {
+      DEBUG("too many completions to keep for the warm-up\n");
+      free(c->warmup_log);
+      c->warmup_log      = NULL;
+      c->warmup_log_full = true;
+      return;
+    }
+    c->warmup_log      = log;
+    c->warmup_log_size = size;
+  }
+
+  sim_warmup_record_t* r = &c->warmup_log[c->warmup_log_len++];
+  r->time                = sim_context_get_current_time(c);
+  r->type                = job->type;
+  r->priority            = job->static_priority;
+  r->size                = sim_time_to_double(job->size);
+  r->value               = value;
+  r->ratio               = ratio;
+  r->realtime_jobs_time  = c->realtime_jobs_time;
+  r->aperiodic_jobs_time = c->aperiodic_jobs_time;
+  r->realtime_size_time  = c->realtime_size_time;
+  r->aperiodic_size_time = c->aperiodic_size_time;
+  r->work_time           = c->work_time;
+  r->busy_time           = c->busy_time;
+}
+
+// the first warmup aperiodic completions were warm-up: start the
+// statistics afresh from the last of them, as if they had been reset then
+// The completions since are replayed and the time-weighted state since is
+// what has accumulated after that completion's snapshot of it.  Without a
+// complete log, the statistics start afresh from now instead.
+static void sim_context_end_warmup(sim_context_t* c, uint64_t warmup) {
+  c->warmup_done = true;
+  c->warmup_jobs = warmup;
+
+  uint64_t cut = 0;
+  for (uint64_t seen = 0; cut < c->warmup_log_len && seen < warmup; cut++) {
+    seen += c->warmup_log[cut].type == SIM_JOB_APERIODIC;
+  }
+
+  if (!warmup) {
+    c->warmup_discarded = 0;
+    c->warmup_time      = c->stats_start;
+  } else if (c->warmup_log_full) {
+    DEBUG("discarding all statistics so far, not just the warm-up\n");
+    c->warmup_discarded = c->resptime.count;
+    c->warmup_time      = sim_context_get_current_time(c);
+    sim_context_reset_stats(c);
+  } else {
+    sim_warmup_record_t* r = &c->warmup_log[cut - 1];
+    double realtime_jobs   = c->realtime_jobs_time - r->realtime_jobs_time;
+    double aperiodic_jobs  = c->aperiodic_jobs_time - r->aperiodic_jobs_time;
+    double realtime_size   = c->realtime_size_time - r->realtime_size_time;
+    double aperiodic_size  = c->aperiodic_size_time - r->aperiodic_size_time;
+    double work            = c->work_time - r->work_time;
+    sim_time_t busy        = c->busy_time - r->busy_time;
+
+    sim_context_reset_stats(c);
+    c->stats_start         = r->time;
+    c->realtime_jobs_time  = realtime_jobs;
+    c->aperiodic_jobs_time = aperiodic_jobs;
+    c->realtime_size_time  = realtime_size;
+    c->aperiodic_size_time = aperiodic_size;
+    c->work_time           = work;
+    c->busy_time           = busy;
+
+    for (uint64_t i = cut; i < c->warmup_log_len; i++) {
+      sim_warmup_record_t* l = &c->warmup_log[i];
+      if (l->type == SIM_JOB_APERIODIC) {
+        sim_context_add_aperiodic(c, l->value, l->ratio, l->priority, l->size);
+      } else {
+        sim_context_add_miss(c, l->type, l->value, l->ratio);
+      }
+    }
+    c->warmup_discarded = warmup;
+    c->warmup_time      = r->time;
+  }
+
+  free(c->warmup_log);
+  c->warmup_log = NULL;
+}
+
 void sim_context_inform_job_done(sim_context_t* c, sim_job_t* job) {
-  double turnaroundtime = sim_context_get_current_time(c) - job->arrival_time;
-  double slowdown       = turnaroundtime / (job->size);
-  bool missed = false;
+  double turnaroundtime = sim_time_to_double(sim_context_get_current_time(c) - job->arrival_time);
+  double slowdown       = turnaroundtime / sim_time_to_double(job->size);
+  bool detecting        = c->warmup && !c->warmup_done;
 
   if (job->type == SIM_JOB_APERIODIC) {
-    c->sum_resptime  += turnaroundtime;
-    c->sum2_resptime += turnaroundtime * turnaroundtime;
-    c->sum_slowdown  += slowdown;
-    c->sum2_slowdown += slowdown * slowdown;
+    // a new batch is the only time the intervals change
+    int batch = sim_context_add_aperiodic(c, turnaroundtime, slowdown, job->static_priority,
+                                          sim_time_to_double(job->size));
+    if (batch && c->stop_precision > 0 && !detecting &&
+        sim_context_precise(c, &c->turnaround_batches) &&
+        sim_context_precise(c, &c->slowdown_batches)) {
+      c->stop_reason = "target precision";
+    }
+
+    // only what follows the warm-up is kept once it is known
+    if (detecting) {
+      sim_context_log_warmup(c, job, turnaroundtime, slowdown);
+      int64_t warmup = sim_mser_add(&c->warmup_mser, turnaroundtime);
+      if (warmup >= 0) {
+        DEBUG("warm-up was %ld jobs, discarding their statistics\n", warmup);
+        sim_context_end_warmup(c, warmup);
+      }
+    }
   } else {
     if (job->deadline < sim_context_get_current_time(c)) {
-      missed = true;
-      double misssize       = sim_context_get_current_time(c) - job->deadline;
-      double avail_interval = job->deadline - job->arrival_time;
+      double misssize       = sim_time_to_double(sim_context_get_current_time(c) - job->deadline);
+      double avail_interval = sim_time_to_double(job->deadline - job->arrival_time);
       double missratio      = misssize / avail_interval;
-      if (job->type == SIM_JOB_SPORADIC) {
-        c->num_sporadic_misses++;
-        c->sum_sporadic_misssize   += misssize;
-        c->sum2_sporadic_misssize  += misssize * misssize;
-        c->sum_sporadic_missratio  += missratio;
-        c->sum2_sporadic_missratio += missratio * missratio;
-      } else {
-        c->num_periodic_misses++;
-        c->sum_periodic_misssize   += misssize;
-        c->sum2_periodic_misssize  += misssize * misssize;
-        c->sum_periodic_missratio  += missratio;
-        c->sum2_periodic_missratio += missratio * missratio;
+      sim_context_add_miss(c, job->type, misssize, missratio);
+      if (detecting) {
+        sim_context_log_warmup(c, job, misssize, missratio);
       }
     }
   }
 
-  sim_context_write_queue_info(c);
-
-  fprintf(c->log_file, "%lf DONE ", sim_context_get_current_time(c));
-  sim_job_print(job, c->log_file);
-  fprintf(c->log_file, "\n");
+  c->num_jobs_done++;
+  if (c->stop_jobs && c->num_jobs_done >= c->stop_jobs) {
+    c->stop_reason = "maximum jobs";
+  }
 
-  if (job->type == SIM_JOB_APERIODIC) {
-    fprintf(c->job_file, "%lf APERIODIC %lf %lf %lf # ",
-            sim_context_get_current_time(c),
-            job->size,
-            turnaroundtime,
-            slowdown);
-    sim_job_print(job, c->job_file);
-    fprintf(c->job_file, "\n");
-  } else if (job->type == SIM_JOB_SPORADIC) {
-    fprintf(c->job_file, "%lf %s %lf %lf %lf %lf # ",
-            sim_context_get_current_time(c),
-            missed ? "SPORADIC_MISS" : "SPORADIC_HIT",
-            job->size,
-            turnaroundtime,
-            slowdown,
-            job->deadline);
-    sim_job_print(job, c->job_file);
-    fprintf(c->job_file, "\n");
-  } else if (job->type == SIM_JOB_PERIODIC) {
-    fprintf(c->job_file, "%lf %s %lf %lf %lf %lf # ",
-            sim_context_get_current_time(c),
-            missed ? "PERIODIC_MISS" : "PERIODIC_HIT",
-            job->size,
-            turnaroundtime,
-            slowdown,
-            job->deadline);
-    sim_job_print(job, c->job_file);
-    fprintf(c->job_file, "\n");
+  if (c->window_log.file) {
+    sim_log_windower_add_completion(&c->windower, job->type == SIM_JOB_APERIODIC ? turnaroundtime : -1);
   }
+
+  sim_context_write_queue_info(c);
+
+  sim_log_write_job(&c->event_log, sim_context_get_current_time(c), SIM_LOG_JOB_DONE, job);
+  sim_log_write_job(&c->job_log, sim_context_get_current_time(c), SIM_LOG_JOB_DONE, job);
 }
 
 void sim_context_inform_job_arrival(sim_context_t* c, sim_job_t* job) {
@@ -485,9 +816,7 @@ void sim_context_inform_job_arrival(sim_context_t* c, sim_job_t* job) {
     c->num_sporadic_jobs++;
   }
   sim_context_write_queue_info(c);
-  fprintf(c->log_file, "%lf JOB_ARRIVAL ", sim_context_get_current_time(c));
-  sim_job_print(job, c->log_file);
-  fprintf(c->log_file, "\n");
+  sim_log_write_job(&c->event_log, sim_context_get_current_time(c), SIM_LOG_JOB_ARRIVAL, job);
 }
 
 void sim_context_inform_task_arrival(sim_context_t* c, sim_job_t* job) {
@@ -496,12 +825,13 @@ void sim_context_inform_task_arrival(sim_context_t* c, sim_job_t* job) {
   }
   c->num_periodic_jobs++;
   sim_context_write_queue_info(c);
-  fprintf(c->log_file, "%lf TASK_ARRIVAL ", sim_context_get_current_time(c));
-  sim_job_print(job, c->log_file);
-  fprintf(c->log_file, "\n");
+  sim_log_write_job(&c->event_log, sim_context_get_current_time(c), SIM_LOG_TASK_ARRIVAL, job);
 }
 
 void sim_context_inform_task_acceptance(sim_context_t* c, sim_job_t* job, sim_sched_acceptance_t rc) {
+  if (rc != SIM_SCHED_REJECT) {
+    c->work += job->size;
+  }
   if (!job->first_arrival) {
     return;
   }
@@ -513,46 +843,24 @@ void sim_context_inform_task_acceptance(sim_context_t* c, sim_job_t* job, sim_sc
 
   sim_context_write_queue_info(c);
 
-  fprintf(c->log_file, "%lf %s ", sim_context_get_current_time(c),
-          (rc == SIM_SCHED_REJECT ? " PERIODIC_TASK_REJECTED " : " PERIODIC_TASK_ACCEPTED "));
-  sim_job_print(job, c->log_file);
-  fprintf(c->log_file, "\n");
-
-  fprintf(c->job_file, "%lf %s ", sim_context_get_current_time(c),
-          (rc == SIM_SCHED_REJECT ? " PERIODIC_TASK_REJECTED " : " PERIODIC_TASK_ACCEPTED "));
-  sim_job_print(job, c->job_file);
-  fprintf(c->job_file, "\n");
+  sim_log_record_type_t type = rc == SIM_SCHED_REJECT ? SIM_LOG_TASK_REJECTED : SIM_LOG_TASK_ACCEPTED;
+  sim_log_write_job(&c->event_log, sim_context_get_current_time(c), type, job);
+  sim_log_write_job(&c->job_log, sim_context_get_current_time(c), type, job);
 }
 
 void sim_context_inform_job_acceptance(sim_context_t* c, sim_job_t* job, sim_sched_acceptance_t rc) {
-  char* acc = NULL;
-  if (rc == SIM_SCHED_REJECT) {
-    acc = "REJECTED";
-    if (job->type != SIM_JOB_APERIODIC) {
-      c->num_sporadic_jobsrejected++;
-    }
-  } else {
-    acc = "ACCEPTED";
+  if (rc != SIM_SCHED_REJECT) {
+    c->work += job->size;
   }
-
-  char* jt = NULL;
-  if (job->type == SIM_JOB_APERIODIC) {
-    jt = "APERIODIC";
-  } else if (job->type == SIM_JOB_SPORADIC) {
-    jt = "SPORADIC";
-  } else {
-    jt = "PERIODIC";
+  if (rc == SIM_SCHED_REJECT && job->type != SIM_JOB_APERIODIC) {
+    c->num_sporadic_jobsrejected++;
   }
 
   sim_context_write_queue_info(c);
 
-  fprintf(c->log_file, "%lf %s_JOB_%s ", sim_context_get_current_time(c), jt, acc);
-  sim_job_print(job, c->log_file);
-  fprintf(c->log_file, "\n");
-
-  fprintf(c->job_file, "%lf %s_JOB_%s # ", sim_context_get_current_time(c), jt, acc);
-  sim_job_print(job, c->job_file);
-  fprintf(c->job_file, "\n");
+  sim_log_record_type_t type = rc == SIM_SCHED_REJECT ? SIM_LOG_JOB_REJECTED : SIM_LOG_JOB_ACCEPTED;
+  sim_log_write_job(&c->event_log, sim_context_get_current_time(c), type, job);
+  sim_log_write_job(&c->job_log, sim_context_get_current_time(c), type, job);
 }
 
 void sim_context_inform_timer_interrupt(sim_context_t* c) {
@@ -560,21 +868,88 @@ void sim_context_inform_timer_interrupt(sim_context_t* c) {
 
   sim_context_write_queue_info(c);
 
-  fprintf(c->log_file, "%lf TIMER\n", sim_context_get_current_time(c));
+  sim_log_write_job(&c->event_log, sim_context_get_current_time(c), SIM_LOG_TIMER, NULL);
 }
 
 
 void sim_context_dispatch_event(sim_context_t* c, sim_event_t* e) {
-  sim_event_dispatch(e);
-  sim_event_complete(e);
-  free(e);
+  sim_context_enter(c);
+  SIM_PROFILE_BEGIN(start);
+  SIM_PROFILE_SET_EVENT(e->type);
+
+  // the queues have not yet changed at this event's time, so they show
+  // the state since the previous change of time
+  if (c->queuelen_log.file && sim_log_sampler_due(&c->queuelen_sampler, e->timestamp)) {
+    sim_log_queuelen_t q;
+    sim_context_get_queue_info(c, &q);
+    sim_log_sampler_advance(&c->queuelen_sampler, &c->queuelen_log, &q, e->timestamp);
+  }
+  if (c->window_log.file && e->timestamp > c->windower.last) {
+    sim_log_queuelen_t q;
+    sim_context_get_queue_info(c, &q);
+    sim_log_windower_advance(&c->windower, &c->window_log, &q, e->timestamp);
+  }
+
+  sim_context_account_time(c, e->timestamp);
+
+  sim_event_dispatch(c, e);
+
+  // embedded events belong to their owner, who may already have re-armed them
+  if (!e->embedded) {
+    sim_event_complete(e);
+    free(e);
+  }
+
+  SIM_PROFILE_END(start, SIM_PROFILE_DISPATCH);
+  SIM_PROFILE_SET_EVENT(SIM_PROFILE_NO_EVENT);
 }
 
-double sim_context_get_current_time(sim_context_t* c) {
+sim_time_t sim_context_get_current_time(sim_context_t* c) {
   return c->event_queue.curtime;
 }
 
+// move commands from an incremental workload into the event queue
+// Every command up to the earliest event goes in front of it, where it
+// would be had the whole workload been loaded before the simulation began
+static int sim_context_feed_events(sim_context_t* context) {
+  sim_workload_source_t* source = context->workload_source;
+  sim_workload_cmd_t* cmd       = sim_workload_source_peek(source);
+  if (!cmd) {
+    return 0;
+  }
+
+  sim_event_t* next = sim_event_queue_peek_earliest_event(&context->event_queue);
+  sim_time_t until  = next ? next->timestamp : cmd->time;
+
+  for (; cmd && cmd->time <= until; cmd = sim_workload_source_peek(source)) {
+    sim_event_t* event = sim_context_create_command_event(context, cmd);
+    if (!event) {
+      return -1;
+    }
+    sim_event_queue_post_before(&context->event_queue, event, next);
+    sim_workload_source_pop(source);
+  }
+
+  return 0;
+}
+
 sim_event_t* sim_context_get_next_event(sim_context_t* context) {
+  sim_context_enter(context);
+  if (context->stop_reason) {
+    return NULL;
+  }
+  if (context->workload_source && sim_context_feed_events(context)) {
+    return NULL;
+  }
+
+  if (context->stop_time) {
+    sim_event_t* next = sim_event_queue_peek_earliest_event(&context->event_queue);
+    if (next && next->timestamp > context->stop_time) {
+      context->stop_reason = "maximum time";
+      return NULL;
+    }
+  }
+
   return sim_event_queue_get_earliest_event(&context->event_queue);
 }
 
@@ -13,11 +13,41 @@
 
 #include "eventqueue.h"
 #include "jobqueue.h"
+#include "logformat.h"
+#include "logwriter.h"
 #include "scheduler.h"
+#include "simtime.h"
+#include "profile.h"
+#include "stats.h"
+#include "trace.h"
 
 
 // forward declarations to avoid header dependency
 typedef struct sim_sched sim_sched_t;
+typedef struct sim_workload_cmd sim_workload_cmd_t;
+typedef struct sim_workload_source sim_workload_source_t;
+
+// a completion kept while the warm-up is being detected, along with the
+// time-weighted state up to it, so the statistics after the truncation
+// point can be rebuilt once it is known
+typedef struct sim_warmup_record {
+  sim_time_t time;
+  sim_job_type_t type;
+  uint64_t priority;
+  double size;
+  double value;               // turnaround, or miss size if realtime
+  double ratio;               // slowdown, or miss ratio if realtime
+  double realtime_jobs_time;
+  double aperiodic_jobs_time;
+  double realtime_size_time;
+  double aperiodic_size_time;
+  double work_time;
+  sim_time_t busy_time;
+} sim_warmup_record_t;
+
+// at most this many completions are kept while detecting the warm-up
+// (about 27 MB), past which the statistics are discarded at detection
+#define SIM_CONTEXT_WARMUP_LOG_MAX (1 << 18)
 
 // nothing in this struct may be modified by schedulers
 typedef struct sim_context {
@@ -28,45 +58,119 @@ typedef struct sim_context {
 
   // scheduler to use and quantum for it
   sim_sched_t* scheduler;
-  double quantum;
-
-  // output log files
-  FILE* queuelen_file;
-  FILE* log_file;
-  FILE* job_file;
+  sim_time_t quantum;
+
+  // output logs, written asynchronously through log_writer
+  sim_log_config_t log_config;
+  sim_log_writer_t log_writer;
+  sim_log_sink_t queuelen_log;
+  sim_log_sink_t event_log;
+  sim_log_sink_t job_log;
+  sim_log_sampler_t queuelen_sampler;
+  sim_log_sink_t window_log;
+  sim_log_windower_t windower;
+
+  // flight recorder for DEBUG() statements
+  sim_trace_t trace;
+
+  // costs of the simulator's own hot path, when profiling
+  sim_profile_t profile;
+
+  // workload still being read as the simulation runs, if any
+  sim_workload_source_t* workload_source;
+
+  // when to end the simulation before the events run out, 0 for never
+  double stop_precision;      // relative half-width of the 95% intervals
+  sim_time_t stop_time;       // simulated time
+  uint64_t stop_jobs;         // completed jobs
+  const char* stop_reason;    // why it ended early, NULL if it did not
+
+  // detect the end of the warm-up (MSER-5 over aperiodic turnaround) and
+  // discard the statistics gathered before it
+  bool warmup;
+  sim_mser_t warmup_mser;
+  bool warmup_done;
+  uint64_t warmup_jobs;       // aperiodic completions found to be warm-up
+  uint64_t warmup_discarded;  // aperiodic completions actually discarded
+  sim_time_t warmup_time;     // time the kept statistics start from
+
+  // completions (aperiodic, and realtime misses) until the warm-up is
+  // detected, NULL after it is or if there were too many to keep
+  sim_warmup_record_t* warmup_log;
+  uint64_t warmup_log_len;
+  uint64_t warmup_log_size;
+  bool warmup_log_full;
 
   // the remainder is statistics tracking
+  uint64_t num_jobs_done;
   uint64_t num_periodic_tasks;
   uint64_t num_periodic_tasksrejected;
   uint64_t num_periodic_jobs;
   uint64_t num_periodic_misses;
-  double sum_periodic_misssize;
-  double sum_periodic_missratio;
-  double sum2_periodic_misssize;
-  double sum2_periodic_missratio;
+  sim_accumulator_t periodic_misssize;
+  sim_accumulator_t periodic_missratio;
 
   uint64_t num_sporadic_jobs;
   uint64_t num_sporadic_jobsrejected;
   uint64_t num_sporadic_misses;
-  double sum_sporadic_misssize;
-  double sum_sporadic_missratio;
-  double sum2_sporadic_misssize;
-  double sum2_sporadic_missratio;
+  sim_accumulator_t sporadic_misssize;
+  sim_accumulator_t sporadic_missratio;
 
   uint64_t num_aperiodic;
-  double sum_resptime;
-  double sum_slowdown;
-  double sum2_resptime;
-  double sum2_slowdown;
+  sim_accumulator_t resptime;
+  sim_accumulator_t slowdown;
 
   uint64_t num_timer_interrupts;
+
+  // distributions, for quantiles
+  int num_quantiles;
+  double quantiles[SIM_STATS_MAX_QUANTILES];
+  sim_histogram_t turnaround_hist;
+  sim_histogram_t slowdown_hist;
+  sim_histogram_t periodic_misssize_hist;
+  sim_histogram_t sporadic_misssize_hist;
+
+  // time-weighted state of the queues since stats_start, accounted as
+  // simulated time advances: integrals over time (in ticks) of the jobs
+  // and the total (original) size of the jobs (in seconds) in each queue,
+  // and of the unfinished work (in seconds) in the whole system
+  sim_time_t stats_start;
+  sim_time_t stats_last;
+  double realtime_jobs_time;
+  double aperiodic_jobs_time;
+  double realtime_size_time;
+  double aperiodic_size_time;
+  double work_time;
+  sim_time_t busy_time;       // with jobs in either queue
+
+  // unfinished work at stats_last: grows by the size of each accepted
+  // job and drains at rate 1 while there are jobs to run
+  sim_time_t work;
+
+  // batch means of the aperiodic jobs, for confidence intervals
+  sim_batch_means_t turnaround_batches;
+  sim_batch_means_t slowdown_batches;
+
+  // aperiodic jobs broken down by static priority and by size
+  sim_class_stats_t priority_class[SIM_STATS_PRIORITY_CLASSES];
+  sim_class_stats_t size_class[SIM_STATS_SIZE_CLASSES];
+
+  // other runs merged into these statistics, and the simulated time their
+  // time-weighted state covers (stats_last keeps this run's own clock)
+  uint64_t num_merged;
+  sim_time_t merged_time;
 } sim_context_t;
 
 
 // simulation creation/completion
-int  sim_context_init(sim_context_t* context, char* sched_name, double quantum);
+// log_config may be NULL for the default logs (see sim_log_config_init)
+int  sim_context_init(sim_context_t*    context,
+                      char*             sched_name,
+                      sim_time_t        quantum,
+                      sim_log_config_t* log_config);
 void sim_context_deinit(sim_context_t* context);
 int  sim_context_load_events(sim_context_t* context, char* filename);
+int  sim_context_add_command(sim_context_t* context, sim_workload_cmd_t* cmd);
 int  sim_context_begin(sim_context_t* context);
 
 // run the simulation
@@ -74,7 +178,7 @@ sim_event_t* sim_context_get_next_event(sim_context_t* context);
 void         sim_context_dispatch_event(sim_context_t* context, sim_event_t* event);
 
 // helper function to get current time in the simulation
-double sim_context_get_current_time(sim_context_t* context);
+sim_time_t sim_context_get_current_time(sim_context_t* context);
 
 // track stats when various scheduling actions occur
 void sim_context_inform_job_arrival(sim_context_t* context, sim_job_t* job);
@@ -84,6 +188,28 @@ void sim_context_inform_task_acceptance(sim_context_t* context, sim_job_t* job,
 void sim_context_inform_job_done(sim_context_t* context, sim_job_t* job);
 void sim_context_inform_timer_interrupt(sim_context_t* context);
 
+// end the simulation once the 95% confidence intervals of the mean
+// turnaround time and slowdown are within precision (relative half-width)
+// of the mean, at time, or after jobs completions, whichever comes first
+// (0 disables a condition)
+void sim_context_set_stop(sim_context_t* context, double precision, sim_time_t time, uint64_t jobs);
+
+// detect the warm-up and keep only the statistics after it
+void sim_context_set_warmup(sim_context_t* context, bool warmup);
+
+// time the event queue, scheduler callbacks, and log writes, and print
+// their costs with the stats
+int  sim_context_set_profile(sim_context_t* context, bool profile);
+
+// quantiles to print with the stats, as percentiles ("50,99,99.9")
+int sim_context_set_quantiles(sim_context_t* context, const char* percentiles);
+
+// add the statistics of another run (a replication, or another thread's
+// share of one) into context, once both have finished
+// The warm-up only counts as detected if it was in both, and either
+// stopping early stops the merged run early
+void sim_context_merge_stats(sim_context_t* context, sim_context_t* other);
+
 // print stats
 void sim_context_print_all(sim_context_t* context, FILE* f);
 void sim_context_print_stats(sim_context_t* context, FILE* f);
@@ -93,3 +219,6 @@ void sim_context_print_event_queue(sim_context_t* context, FILE* f);
 // use external tool to display a graph of results
 void sim_context_display_queue_depths(sim_context_t* context);
 
+// print the recent DEBUG() statements held by the trace
+void sim_context_dump_trace(sim_context_t* context, FILE* f);
+
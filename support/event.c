@@ -28,14 +28,13 @@
 
 
 // monotonically increasing value used to assign event IDs
-static uint64_t current_event_id = 0;
+static uint32_t current_event_id = 0;
 
 
 /* Internal helper functions */
 
 static void sim_event_init(sim_event_t*     e,
-                           double           time,
-                           sim_context_t*   context,
+                           sim_time_t       time,
                            sim_event_type_t type,
                            sim_job_t*       job) {
   memset(e, 0, sizeof(*e));
@@ -43,7 +42,6 @@ static void sim_event_init(sim_event_t*     e,
   e->id = current_event_id++;
 
   e->timestamp = time;
-  e->context   = context;
   e->type      = type;
   e->job       = job;
 
@@ -53,8 +51,22 @@ static void sim_event_init(sim_event_t*     e,
 
 /* Public functions */
 
-sim_event_t* sim_event_create(double           time,
-                              sim_context_t*   context,
+char* sim_event_type_name(sim_event_type_t type) {
+  return type == SIM_EVENT_PERIODIC_TASK_ARRIVAL ? "PERIODIC_TASK_ARRIVAL" :
+         type == SIM_EVENT_SPORADIC_JOB_ARRIVAL  ? "SPORADIC_JOB_ARRIVAL" :
+         type == SIM_EVENT_APERIODIC_JOB_ARRIVAL  ? "APERIODIC_JOB_ARRIVAL" :
+         type == SIM_EVENT_JOB_DONE ? "JOB_DONE" :
+         type == SIM_EVENT_TIMER ? "TIMER" :
+         type == SIM_EVENT_PRINT_STATS ? "PRINT_STATS" :
+         type == SIM_EVENT_PRINT_ALL ? "PRINT_ALL" :
+         type == SIM_EVENT_PRINT_JOB_QUEUES ? "PRINT_JOB_QUEUES" :
+         type == SIM_EVENT_PRINT_EVENT_QUEUE ? "PRINT_EVENT_QUEUE" :
+         type == SIM_EVENT_DISPLAY_QUEUE_DEPTHS ? "DISPLAY_QUEUE_DEPTHS" :
+         type == SIM_EVENT_DUMP_TRACE ? "DUMP_TRACE" :
+         "UNKNOWN";
+}
+
+sim_event_t* sim_event_create(sim_time_t       time,
                               sim_event_type_t type,
                               sim_job_t*       job) {
   sim_event_t* e = malloc(sizeof(sim_event_t));
@@ -63,88 +75,102 @@ sim_event_t* sim_event_create(double           time,
     return NULL;
   }
 
-  sim_event_init(e, time, context, type, job);
+  sim_event_init(e, time, type, job);
 
   return e;
 }
 
-void sim_event_dispatch(sim_event_t* e) {
+void sim_event_init_embedded(sim_event_t*     e,
+                             sim_event_type_t type) {
+  sim_event_init(e, 0, type, NULL);
+  e->embedded = true;
+}
+
+void sim_event_dispatch(sim_context_t* c, sim_event_t* e) {
 
   // inform context of event occurring
   // call appropriate scheduler function, if any
-  double current_time = sim_context_get_current_time(e->context);
+  sim_time_t current_time = sim_context_get_current_time(c);
   sim_sched_acceptance_t rc;
+
+  DEBUG("dispatch event %u %s job %lu\n",
+        e->id, sim_event_type_name(e->type), e->job ? e->job->id : 0);
   switch (e->type) {
     case SIM_EVENT_PERIODIC_TASK_ARRIVAL:
-      sim_context_inform_task_arrival(e->context, e->job);
+      sim_context_inform_task_arrival(c, e->job);
 
-      rc = sim_sched_periodic_task_arrival(e->context->scheduler,
-                                           e->context,
+      rc = sim_sched_periodic_task_arrival(c->scheduler,
+                                           c,
                                            current_time,
                                            e->job);
 
-      sim_context_inform_task_acceptance(e->context, e->job, rc);
+      sim_context_inform_task_acceptance(c, e->job, rc);
 
       break;
 
     case SIM_EVENT_SPORADIC_JOB_ARRIVAL:
-      sim_context_inform_job_arrival(e->context, e->job);
+      sim_context_inform_job_arrival(c, e->job);
 
-      rc = sim_sched_sporadic_job_arrival(e->context->scheduler,
-                                          e->context,
+      rc = sim_sched_sporadic_job_arrival(c->scheduler,
+                                          c,
                                           current_time,
                                           e->job);
 
-      sim_context_inform_job_acceptance(e->context, e->job, rc);
+      sim_context_inform_job_acceptance(c, e->job, rc);
 
       break;
 
     case SIM_EVENT_APERIODIC_JOB_ARRIVAL:
-      sim_context_inform_job_arrival(e->context, e->job);
+      sim_context_inform_job_arrival(c, e->job);
 
-      rc = sim_sched_aperiodic_job_arrival(e->context->scheduler,
-                                           e->context,
+      rc = sim_sched_aperiodic_job_arrival(c->scheduler,
+                                           c,
                                            current_time,
                                            e->job);
 
-      sim_context_inform_job_acceptance(e->context, e->job, rc);
+      sim_context_inform_job_acceptance(c, e->job, rc);
 
       break;
 
     case SIM_EVENT_JOB_DONE:
-      sim_context_inform_job_done(e->context, e->job);
-      sim_sched_job_done(e->context->scheduler, e->context, current_time, e->job);
+      sim_context_inform_job_done(c, e->job);
+      sim_sched_job_done(c->scheduler, c, current_time, e->job);
 
       break;
 
     case SIM_EVENT_TIMER:
-      sim_context_inform_timer_interrupt(e->context);
-      sim_sched_timer_interrupt(e->context->scheduler, e->context, current_time);
+      sim_context_inform_timer_interrupt(c);
+      sim_sched_timer_interrupt(c->scheduler, c, current_time);
 
       break;
 
     case SIM_EVENT_PRINT_STATS:
-      sim_context_print_stats(e->context, stdout);
+      sim_context_print_stats(c, stdout);
 
       break;
 
     case SIM_EVENT_PRINT_JOB_QUEUES:
-      sim_context_print_job_queues(e->context, stdout);
+      sim_context_print_job_queues(c, stdout);
 
       break;
 
     case SIM_EVENT_PRINT_EVENT_QUEUE:
-      sim_context_print_event_queue(e->context, stdout);
+      sim_context_print_event_queue(c, stdout);
 
       break;
 
     case SIM_EVENT_PRINT_ALL:
-      sim_context_print_all(e->context, stdout);
+      sim_context_print_all(c, stdout);
 
       break;
 
     case SIM_EVENT_DISPLAY_QUEUE_DEPTHS:
-      sim_context_display_queue_depths(e->context);
+      sim_context_display_queue_depths(c);
+
+      break;
+
+    case SIM_EVENT_DUMP_TRACE:
+      sim_context_dump_trace(c, stderr);
 
       break;
 
@@ -155,19 +181,8 @@ void sim_event_dispatch(sim_event_t* e) {
 }
 
 void sim_event_print(sim_event_t* e, FILE* f) {
-  fprintf(f, "event %lu time %lf %s ",
-          e->id, e->timestamp,
-          e->type == SIM_EVENT_PERIODIC_TASK_ARRIVAL ? "PERIODIC_TASK_ARRIVAL" :
-          e->type == SIM_EVENT_SPORADIC_JOB_ARRIVAL  ? "SPORADIC_JOB_ARRIVAL" :
-          e->type == SIM_EVENT_APERIODIC_JOB_ARRIVAL  ? "APERIODIC_JOB_ARRIVAL" :
-          e->type == SIM_EVENT_JOB_DONE ? "JOB_DONE" :
-          e->type == SIM_EVENT_TIMER ? "TIMER" :
-          e->type == SIM_EVENT_PRINT_STATS ? "PRINT_STATS" :
-          e->type == SIM_EVENT_PRINT_ALL ? "PRINT_ALL" :
-          e->type == SIM_EVENT_PRINT_JOB_QUEUES ? "PRINT_JOB_QUEUES" :
-          e->type == SIM_EVENT_PRINT_EVENT_QUEUE ? "PRINT_EVENT_QUEUE" :
-          e->type == SIM_EVENT_DISPLAY_QUEUE_DEPTHS ? "DISPLAY_QUEUE_DEPTHS" :
-          "UNKNOWN");
+  fprintf(f, "event %u time %lf %s ",
+          e->id, sim_time_to_double(e->timestamp), sim_event_type_name(e->type));
   switch (e->type) {
     case SIM_EVENT_PERIODIC_TASK_ARRIVAL:
     case SIM_EVENT_SPORADIC_JOB_ARRIVAL:
@@ -14,6 +14,7 @@
 #include "context.h"
 #include "job.h"
 #include "list.h"
+#include "simtime.h"
 
 
 // forward declarations to avoid header dependency
@@ -32,38 +33,52 @@ typedef enum {
   SIM_EVENT_PRINT_JOB_QUEUES,
   SIM_EVENT_PRINT_EVENT_QUEUE,
   SIM_EVENT_DISPLAY_QUEUE_DEPTHS,
+  SIM_EVENT_DUMP_TRACE,
 } sim_event_type_t;
 
 // nothing in this struct may be modified by schedulers
+// fields are ordered so that the ones the event queue compares while
+// walking (node, timestamp) come first, and the whole event is 40 bytes
+// the context is not stored here, it is supplied when dispatching
 typedef struct sim_event {
-  // details about the event
-  uint64_t id;
-  double timestamp;
-  sim_event_type_t type;
+  // an event can be in only one list at a time
+  struct list_head node;
 
-  // the simulation context
-  sim_context_t* context;
+  // details about the event
+  sim_time_t timestamp;
 
   // the job this event is associated with
   // set to NULL if there is no associated job
   sim_job_t* job;
 
-  // an event can be in only one list at a time
-  struct list_head node;
+  // id is only used for debugging output and wraps after 2^32 events
+  uint32_t id;
+  uint8_t type; // a sim_event_type_t
+
+  // true if the event is owned by something other than the simulation
+  // loop, either a slot inside scheduler state or a periodic task's
+  // arrival event; embedded events are never freed by the simulation
+  bool embedded;
 } sim_event_t;
 
 
 // must be called to create an event
-sim_event_t* sim_event_create(double           time,
-                              sim_context_t*   context,
+sim_event_t* sim_event_create(sim_time_t       time,
                               sim_event_type_t type,
                               sim_job_t*       job);
 
+// initialize an event slot embedded in another structure
+// it is not in the event queue until armed with sim_event_queue_reschedule()
+// and may be re-armed that way as often as needed, without allocation
+void sim_event_init_embedded(sim_event_t*     event,
+                             sim_event_type_t type);
+
 // called internally by the main simulation loop
-void sim_event_dispatch(sim_event_t* event);
+void sim_event_dispatch(sim_context_t* context, sim_event_t* event);
 
 // called internally to print event details
 void sim_event_print(sim_event_t* event, FILE* f);
+char* sim_event_type_name(sim_event_type_t type);
 
 // must be called when events are completed
 void sim_event_complete(sim_event_t* event);
@@ -13,6 +13,7 @@
 #include "debug.h"
 #include "event.h"
 #include "eventqueue.h"
+#include "profile.h"
 
 
 // control debugging prints throughout this file
@@ -25,19 +26,17 @@
 #define INFO(fmt, args...)  INFO_PRINT("eventqueue: " fmt, ##args)
 
 
-/* Public functions */
-
-void sim_event_queue_init(sim_event_queue_t* eq) {
-  memset(eq, 0, sizeof(*eq));
-
-  INIT_LIST_HEAD(&eq->list);
-}
+/* Private functions */
 
-void sim_event_queue_post(sim_event_queue_t* eq, sim_event_t* e) {
+static void sim_event_queue_insert(sim_event_queue_t* eq, sim_event_t* e) {
   if (list_empty(&eq->list)) {
     // DEBUG("empty list insert new %lf\n",e->timestamp);
     list_add(&e->node, &eq->list);
     return;
+  } else if (e->timestamp >= list_entry(eq->list.prev, sim_event_t, node)->timestamp) {
+    // workloads are (mostly) in time order, so loading one appends
+    list_add_tail(&e->node, &eq->list);
+    return;
   } else {
     struct list_head* cur;
     list_for_each(cur, &eq->list) {
@@ -55,6 +54,25 @@ void sim_event_queue_post(sim_event_queue_t* eq, sim_event_t* e) {
   }
 }
 
+
+/* Public functions */
+
+void sim_event_queue_init(sim_event_queue_t* eq) {
+  memset(eq, 0, sizeof(*eq));
+
+  INIT_LIST_HEAD(&eq->list);
+}
+
+void sim_event_queue_post(sim_event_queue_t* eq, sim_event_t* e) {
+  SIM_PROFILE_BEGIN(start);
+  sim_event_queue_insert(eq, e);
+  SIM_PROFILE_END(start, SIM_PROFILE_EVENT_POST);
+}
+
+void sim_event_queue_post_before(sim_event_queue_t* eq, sim_event_t* e, sim_event_t* next) {
+  list_add_tail(&e->node, next ? &next->node : &eq->list);
+}
+
 void sim_event_queue_delete(sim_event_queue_t* eq, sim_event_t* e) {
   list_del_init(&e->node);
 }
@@ -64,8 +82,50 @@ void sim_event_queue_update(sim_event_queue_t* eq, sim_event_t* e) {
   sim_event_queue_post(eq, e);
 }
 
+void sim_event_queue_reschedule(sim_event_queue_t* eq,
+                                sim_event_t*       e,
+                                sim_time_t         new_time,
+                                sim_job_t*         new_job) {
+  SIM_PROFILE_BEGIN(start);
+  sim_time_t old_time = e->timestamp;
+
+  e->job = new_job;
+
+  if (list_empty(&e->node)) {
+    e->timestamp = new_time;
+    sim_event_queue_insert(eq, e);
+    SIM_PROFILE_END(start, SIM_PROFILE_EVENT_RESCHEDULE);
+    return;
+  }
+
+  // walk from the current position rather than from the head, since
+  // preemption usually moves an event only a short distance
+  struct list_head* pos = e->node.next;
+  list_del_init(&e->node);
+  e->timestamp = new_time;
+
+  if (new_time >= old_time) {
+    // later: skip forward past everything at or before the new time
+    while (pos != &eq->list &&
+           list_entry(pos, sim_event_t, node)->timestamp <= new_time) {
+      pos = pos->next;
+    }
+    list_add_tail(&e->node, pos);
+  } else {
+    // earlier: skip backward past everything after the new time
+    pos = pos->prev;
+    while (pos != &eq->list &&
+           list_entry(pos, sim_event_t, node)->timestamp > new_time) {
+      pos = pos->prev;
+    }
+    list_add(&e->node, pos);
+  }
+
+  SIM_PROFILE_END(start, SIM_PROFILE_EVENT_RESCHEDULE);
+}
+
 void sim_event_queue_print(sim_event_queue_t* eq, FILE* f) {
-  fprintf(f, "event queue curtime %lf, events follow:\n", eq->curtime);
+  fprintf(f, "event queue curtime %lf, events follow:\n", sim_time_to_double(eq->curtime));
   struct list_head* cur;
   list_for_each(cur, &eq->list) {
     sim_event_t* cur_event = list_entry(cur, sim_event_t, node);
@@ -75,13 +135,25 @@ void sim_event_queue_print(sim_event_queue_t* eq, FILE* f) {
 }
 
 sim_event_t* sim_event_queue_get_earliest_event(sim_event_queue_t* eq) {
-  if (list_empty(&eq->list)) {
-    return NULL;
-  } else {
-    sim_event_t* cur_event = list_entry(eq->list.next, sim_event_t, node);
+  SIM_PROFILE_BEGIN(start);
+  sim_event_t* cur_event = NULL;
+
+  if (!list_empty(&eq->list)) {
+    cur_event = list_entry(eq->list.next, sim_event_t, node);
     list_del_init(eq->list.next);
     eq->curtime = cur_event->timestamp;
-    return cur_event;
   }
+
+  // charged to the event it gets, which is about to be dispatched
+  SIM_PROFILE_END_TYPE(start, SIM_PROFILE_EVENT_GET,
+                       cur_event ? cur_event->type : SIM_PROFILE_NO_EVENT);
+  return cur_event;
+}
+
+sim_event_t* sim_event_queue_peek_earliest_event(sim_event_queue_t* eq) {
+  if (list_empty(&eq->list)) {
+    return NULL;
+  }
+  return list_entry(eq->list.next, sim_event_t, node);
 }
 
@@ -8,16 +8,18 @@
 #pragma once
 
 #include "list.h"
+#include "simtime.h"
 
 
-// forward declaration to avoid header dependency
+// forward declarations to avoid header dependency
 typedef struct sim_event sim_event_t;
+typedef struct sim_job sim_job_t;
 
 
 // nothing in this struct may be modified by schedulers
 typedef struct sim_event_queue {
   // current point in time that the event queue has reached
-  double curtime;
+  sim_time_t curtime;
 
   // Will be maintained in sorted order (O(n) insert, O(1) remove)
   // A much smarter structure would be priority heap (O(lg n) insert, O(1) remove)
@@ -32,15 +34,36 @@ void sim_event_queue_init(sim_event_queue_t* eq);
 // place an event into the queue for the first time
 void sim_event_queue_post(sim_event_queue_t* eq, sim_event_t* e);
 
+// place an event into the queue immediately before next (at the end if
+// next is NULL), which the caller knows keeps the queue in time order
+void sim_event_queue_post_before(sim_event_queue_t* eq, sim_event_t* e, sim_event_t* next);
+
 // change an event that is already in the queue (for example, timestamp change)
 void sim_event_queue_update(sim_event_queue_t* eq, sim_event_t* e);
 
 // delete an event from the queue
+// the event is only unlinked, the caller still owns it and must free it
 void sim_event_queue_delete(sim_event_queue_t* eq, sim_event_t* e);
 
+// move an event to a new time (and possibly a new job) without reallocating
+// works for both earlier (decrease-key) and later (increase-key) times, and
+// places the event after any events with the same time, just like a fresh post
+// if the event is not currently in the queue, it is simply posted
+// ownership does not change: an embedded event (the done, timer, and
+// arrival events this is meant for) stays owned by the scheduler state or
+// job it is embedded in and is never freed after dispatch, and only a
+// non-embedded event is freed after it is dispatched
+void sim_event_queue_reschedule(sim_event_queue_t* eq,
+                                sim_event_t*       e,
+                                sim_time_t         new_time,
+                                sim_job_t*         new_job);
+
 // print the entire event queue
 void sim_event_queue_print(sim_event_queue_t* eq, FILE* dest);
 
 // return earliest event in the queue
 sim_event_t* sim_event_queue_get_earliest_event(sim_event_queue_t* eq);
 
+// return earliest event without removing it, NULL if the queue is empty
+sim_event_t* sim_event_queue_peek_earliest_event(sim_event_queue_t* eq);
+
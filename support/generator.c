@@ -0,0 +1,704 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "generator.h"
+#include "workload.h"
+
+
+// control debugging prints throughout this file
+#if DEBUG_GENERATOR
+#define DEBUG(fmt, args...) DEBUG_PRINT("generator: " fmt, ##args)
+#else
+#define DEBUG(fmt, args...)
+#endif
+#define ERROR(fmt, args...) ERROR_PRINT("generator: " fmt, ##args)
+#define INFO(fmt, args...)  INFO_PRINT("generator: " fmt, ##args)
+
+
+/* Random numbers */
+
+static inline uint64_t rotl(uint64_t x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_next(sim_rng_t* rng) {
+  uint64_t* s      = rng->s;
+  uint64_t result  = rotl(s[1] * 5, 7) * 9;
+  uint64_t t       = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3]  = rotl(s[3], 45);
+
+  return result;
+}
+
+void sim_rng_seed(sim_rng_t* rng, uint64_t seed) {
+  // expand the seed with splitmix64, as the xoshiro authors recommend
+  for (int i = 0; i < 4; i++) {
+    uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    rng->s[i] = z ^ (z >> 31);
+  }
+}
+
+double sim_rng_uniform(sim_rng_t* rng) {
+  return (rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+void sim_rng_fill_uniform(sim_rng_t* rng, double* out, unsigned n) {
+  for (unsigned i = 0; i < n; i++) {
+    out[i] = (rng_next(rng) >> 11) * 0x1.0p-53;
+  }
+}
+
+// The distributions are transformed from a block of uniform draws in
+// separate loops, which keeps the generator's dependency chain out of the
+// loops that call log() and exp()
+
+void sim_rng_fill_exp(sim_rng_t* rng, double* out, unsigned n, double mean) {
+  // 1 - u is in (0, 1], so the log is finite
+  sim_rng_fill_uniform(rng, out, n);
+  for (unsigned i = 0; i < n; i++) {
+    out[i] = -mean * log(1.0 - out[i]);
+  }
+}
+
+void sim_rng_fill_pareto(sim_rng_t* rng, double* out, unsigned n, double alpha) {
+  // 1/u^(1/alpha) as in Gen.pm, u in (0, 1]
+  sim_rng_fill_uniform(rng, out, n);
+  for (unsigned i = 0; i < n; i++) {
+    out[i] = exp(-log(1.0 - out[i]) / alpha);
+  }
+}
+
+
+/* Configuration */
+
+// parse "a:b:c" into up to n numbers, leaving the rest unchanged
+static int parse_numbers(const char* s, double* out[], int n) {
+  char* end;
+  for (int i = 0; i < n && *s; i++) {
+    *out[i] = strtod(s, &end);
+    if (end == s || (*end && *end != ':')) {
+      return -1;
+    }
+    s = *end ? end + 1 : end;
+  }
+  return *s ? -1 : 0;
+}
+
+static int mix_from_env(char* name, double* out[], int n) {
+  char* s = getenv(name);
+  if (s && parse_numbers(s, out, n)) {
+    ERROR("bad %s=%s\n", name, s);
+    return -1;
+  }
+  return 0;
+}
+
+int sim_gen_config_init(sim_gen_config_t* c) {
+  memset(c, 0, sizeof(*c));
+  c->arrival        = SIM_GEN_ARRIVAL_POISSON;
+  c->mu_arr         = 1.0;
+  c->size           = SIM_GEN_SIZE_EXP;
+  c->size_param     = 1.0;
+  c->tmax           = -1;
+
+  c->aperiodic_prob = 1.0;
+  c->priority_low   = 0;
+  c->priority_high  = 100;
+  c->sporadic_prob  = 0.0;
+  c->deadline_low   = 2.0;
+  c->deadline_high  = 8.0;
+  c->periodic_prob  = 0.0;
+  c->period_low     = 2.0;
+  c->period_high    = 8.0;
+  c->iters_low      = 10;
+  c->iters_high     = 100;
+
+  if (mix_from_env("APERIODIC",
+                   (double*[]){ &c->aperiodic_prob, &c->priority_low, &c->priority_high }, 3) ||
+      mix_from_env("SPORADIC",
+                   (double*[]){ &c->sporadic_prob, &c->deadline_low, &c->deadline_high }, 3) ||
+      mix_from_env("PERIODIC",
+                   (double*[]){ &c->periodic_prob, &c->period_low, &c->period_high,
+                                &c->iters_low, &c->iters_high }, 5)) {
+    return -1;
+  }
+
+  if (fabs(c->aperiodic_prob + c->sporadic_prob + c->periodic_prob - 1.0) > 1e-9) {
+    ERROR("job mix probabilities do not sum to 1.0\n");
+    return -1;
+  }
+
+  // integer ranges are truncated, as make_arrivals.pl does
+  c->priority_low  = trunc(c->priority_low);
+  c->priority_high = trunc(c->priority_high);
+  c->iters_low     = trunc(c->iters_low);
+  c->iters_high    = trunc(c->iters_high);
+
+  return 0;
+}
+
+typedef struct profile {
+  char* name;
+  sim_gen_profile_t profile;
+  int min_params;
+  int max_params;
+  // whether each parameter must be positive, rather than not negative
+  bool positive[2];
+} profile_t;
+
+static profile_t profiles[] = {
+  { "ramp",     SIM_GEN_PROFILE_RAMP,      1, 2, { true,  false } },
+  { "stepramp", SIM_GEN_PROFILE_STEP_RAMP, 2, 2, { true,  true  } },
+  { "sawtooth", SIM_GEN_PROFILE_SAWTOOTH,  2, 2, { true,  true  } },
+  { "sine",     SIM_GEN_PROFILE_SINE,      2, 2, { true,  true  } },
+  { "exp",      SIM_GEN_PROFILE_EXP,       1, 1, { true,  false } },
+  { "log",      SIM_GEN_PROFILE_LOG,       1, 1, { true,  false } },
+  { "step",     SIM_GEN_PROFILE_STEP,      2, 2, { false, true  } },
+};
+
+static int profile_check(sim_gen_config_t* c, const char* spec);
+
+// parse "a,b,c" into at most max numbers, returning how many
+static int parse_list(const char* s, double* out, int max) {
+  char* end;
+  int n = 0;
+  while (1) {
+    if (n == max) {
+      return -1;
+    }
+    out[n++] = strtod(s, &end);
+    if (end == s || (*end && *end != ',')) {
+      return -1;
+    }
+    if (!*end) {
+      return n;
+    }
+    s = end + 1;
+  }
+}
+
+// parse the rows "a,b/c,d" of an n by n matrix
+static int parse_matrix(char* s, double m[SIM_GEN_MAX_STATES][SIM_GEN_MAX_STATES], int n) {
+  char* save;
+  int row = 0;
+  for (char* r = strtok_r(s, "/", &save); r; r = strtok_r(NULL, "/", &save)) {
+    if (row == n || parse_list(r, m[row++], SIM_GEN_MAX_STATES) != n) {
+      return -1;
+    }
+  }
+  return row == n ? 0 : -1;
+}
+
+int sim_gen_config_parse(sim_gen_config_t* c, const char* spec) {
+  char buf[256];
+  if (strlen(spec) >= sizeof(buf)) {
+    ERROR("spec too long\n");
+    return -1;
+  }
+  strcpy(buf, spec);
+
+  // the process name, its numeric parameters, then key=value options
+  char* save;
+  char* name = strtok_r(buf, ":", &save);
+  double params[8];
+  int num_params = 0;
+  char* matrix   = NULL;
+
+  for (char* tok = strtok_r(NULL, ":", &save); tok; tok = strtok_r(NULL, ":", &save)) {
+    char* end;
+    char* eq = strchr(tok, '=');
+
+    if (!eq) {
+      if (num_params == 8) {
+        ERROR("too many parameters in %s\n", spec);
+        return -1;
+      }
+      params[num_params++] = strtod(tok, &end);
+      if (end == tok || *end) {
+        ERROR("bad parameter %s in %s\n", tok, spec);
+        return -1;
+      }
+    } else if (!strncmp(tok, "T=", 2)) {
+      c->tmax = strtod(eq + 1, &end);
+      if (end == eq + 1 || *end) {
+        ERROR("bad time %s in %s\n", tok, spec);
+        return -1;
+      }
+    } else if (!strncmp(tok, "seed=", 5)) {
+      c->seed     = strtoull(eq + 1, &end, 0);
+      c->has_seed = true;
+      if (end == eq + 1 || *end) {
+        ERROR("bad seed %s in %s\n", tok, spec);
+        return -1;
+      }
+    } else if (!strncmp(tok, "size=", 5) || !strncmp(tok, "alpha=", 6)) {
+      c->size       = tok[0] == 's' ? SIM_GEN_SIZE_EXP : SIM_GEN_SIZE_PARETO;
+      c->size_param = strtod(eq + 1, &end);
+      if (end == eq + 1 || *end) {
+        ERROR("bad size %s in %s\n", tok, spec);
+        return -1;
+      }
+    } else if (!strncmp(tok, "rates=", 6)) {
+      c->num_states = parse_list(eq + 1, c->state_rate, SIM_GEN_MAX_STATES);
+      if (c->num_states < 0) {
+        ERROR("bad rates %s in %s (at most %d)\n", tok, spec, SIM_GEN_MAX_STATES);
+        return -1;
+      }
+    } else if (!strncmp(tok, "Q=", 2)) {
+      // parsed once the number of states is known
+      matrix = eq + 1;
+    } else if (!strncmp(tok, "sources=", 8)) {
+      c->num_sources = strtol(eq + 1, &end, 0);
+      if (end == eq + 1 || *end || c->num_sources < 1 || c->num_sources > SIM_GEN_MAX_SOURCES) {
+        ERROR("bad sources %s in %s (at most %d)\n", tok, spec, SIM_GEN_MAX_SOURCES);
+        return -1;
+      }
+    } else {
+      ERROR("unknown option %s in %s\n", tok, spec);
+      return -1;
+    }
+  }
+
+  if (!name) {
+    ERROR("empty spec\n");
+    return -1;
+  }
+
+  if (!strcmp(name, "expexp") || !strcmp(name, "exppareto")) {
+    if (num_params != 2) {
+      ERROR("%s needs 2 parameters\n", name);
+      return -1;
+    }
+    c->arrival    = SIM_GEN_ARRIVAL_POISSON;
+    c->mu_arr     = params[0];
+    c->size       = !strcmp(name, "expexp") ? SIM_GEN_SIZE_EXP : SIM_GEN_SIZE_PARETO;
+    c->size_param = params[1];
+    if (c->mu_arr <= 0) {
+      ERROR("parameters of %s must be positive\n", spec);
+      return -1;
+    }
+  } else if (!strcmp(name, "mmpp")) {
+    if (num_params || !c->num_states || !matrix) {
+      ERROR("mmpp needs rates= and Q=\n");
+      return -1;
+    }
+    if (parse_matrix(matrix, c->state_switch, c->num_states)) {
+      ERROR("Q must be %d rows of %d rates\n", c->num_states, c->num_states);
+      return -1;
+    }
+    for (int i = 0; i < c->num_states; i++) {
+      for (int j = 0; j < c->num_states; j++) {
+        if (c->state_rate[i] < 0 || (i != j && c->state_switch[i][j] < 0)) {
+          ERROR("mmpp rates must not be negative\n");
+          return -1;
+        }
+      }
+    }
+    c->arrival = SIM_GEN_ARRIVAL_MMPP;
+  } else if (!strcmp(name, "onoff")) {
+    if (num_params != 4) {
+      ERROR("onoff needs 4 parameters\n");
+      return -1;
+    }
+    c->arrival     = SIM_GEN_ARRIVAL_ONOFF;
+    c->on_rate     = params[0];
+    c->on_mean     = params[1];
+    c->off_mean    = params[2];
+    c->onoff_alpha = params[3];
+    if (c->on_rate <= 0 || c->on_mean <= 0 || c->off_mean <= 0 || c->onoff_alpha <= 1) {
+      ERROR("onoff needs positive rate and means, and alpha > 1\n");
+      return -1;
+    }
+    if (!c->num_sources) {
+      c->num_sources = 1;
+    }
+  } else {
+    profile_t* p = NULL;
+    for (size_t i = 0; i < sizeof(profiles) / sizeof(profiles[0]); i++) {
+      if (!strcmp(name, profiles[i].name)) {
+        p = &profiles[i];
+      }
+    }
+    if (!p) {
+      ERROR("unknown arrival process %s\n", name);
+      return -1;
+    }
+    if (num_params < p->min_params || num_params > p->max_params) {
+      ERROR("%s needs %d parameters\n", name, p->min_params);
+      return -1;
+    }
+    c->arrival          = SIM_GEN_ARRIVAL_PROFILE;
+    c->profile          = p->profile;
+    c->profile_param[0] = params[0];
+    c->profile_param[1] = num_params > 1 ? params[1] : 0;
+    // the bounds used for thinning assume these signs (and NaN fails both)
+    for (int i = 0; i < 2; i++) {
+      double x = c->profile_param[i];
+      if (p->positive[i] ? !(x > 0) : !(x >= 0)) {
+        ERROR("parameter %d of %s must be %s\n", i + 1, name,
+              p->positive[i] ? "positive" : "non-negative");
+        return -1;
+      }
+    }
+  }
+
+  if (c->size_param <= 0) {
+    ERROR("size parameter of %s must be positive\n", spec);
+    return -1;
+  }
+  if (c->arrival == SIM_GEN_ARRIVAL_PROFILE && c->size == SIM_GEN_SIZE_PARETO && c->size_param <= 1) {
+    ERROR("a profile needs Pareto sizes with a finite mean (alpha > 1)\n");
+    return -1;
+  }
+  if (c->tmax < 0) {
+    ERROR("%s needs a time limit (T=secs)\n", spec);
+    return -1;
+  }
+
+  // a ramp stays at its maximum for staytime after T
+  c->profile_end = c->tmax;
+  if (c->arrival == SIM_GEN_ARRIVAL_PROFILE && c->profile == SIM_GEN_PROFILE_RAMP) {
+    c->tmax += c->profile_param[1];
+  }
+  if (c->arrival == SIM_GEN_ARRIVAL_PROFILE && profile_check(c, spec)) {
+    return -1;
+  }
+
+  return 0;
+}
+
+
+/* Contention profiles */
+
+// offered load of a profile at time t, as in Gen.pm's Make*Contention
+static double profile_load(sim_gen_config_t* c, double t) {
+  double a   = c->profile_param[0];
+  double b   = c->profile_param[1];
+  double end = c->profile_end;
+
+  switch (c->profile) {
+    case SIM_GEN_PROFILE_RAMP:
+      return t < end ? a * t / end : a;
+    case SIM_GEN_PROFILE_STEP_RAMP:
+      return floor(t / a) * a * b / end;
+    case SIM_GEN_PROFILE_SAWTOOTH:
+      return (t * b - floor(t * b)) * a;
+    case SIM_GEN_PROFILE_SINE:
+      return a / 2 + (a / 2) * sin(b * t);
+    case SIM_GEN_PROFILE_EXP:
+      return exp(t / a);
+    case SIM_GEN_PROFILE_LOG:
+      return log(M_E + t * a) - 1;
+    case SIM_GEN_PROFILE_STEP:
+      return t >= a ? b : 0;
+  }
+  return 0;
+}
+
+static double mean_size(sim_gen_config_t* c) {
+  if (c->size == SIM_GEN_SIZE_EXP) {
+    return c->size_param;
+  }
+  return c->size_param / (c->size_param - 1);
+}
+
+double sim_gen_profile_rate(sim_gen_config_t* c, double t) {
+  return fmax(profile_load(c, t), 0) / mean_size(c);
+}
+
+// upper bound on the rate over [t0, t1]
+static double profile_bound(sim_gen_config_t* c, double t0, double t1) {
+  switch (c->profile) {
+    case SIM_GEN_PROFILE_SAWTOOTH:
+    case SIM_GEN_PROFILE_SINE:
+      return fmax(c->profile_param[0], 0) / mean_size(c);
+    default:
+      // the rest never decrease
+      return sim_gen_profile_rate(c, t1);
+  }
+}
+
+// past this many arrivals (on average) the gaps between them fall toward
+// the resolution of a double at T, and thinning would stop advancing time
+#define PROFILE_MAX_ARRIVALS 1e15
+
+// the rate must be finite everywhere on [0, T] for thinning to work, and
+// the largest is the bound over all of it
+static int profile_check(sim_gen_config_t* c, const char* spec) {
+  double peak = profile_bound(c, 0, c->tmax);
+  if (!isfinite(peak) || !(peak * c->tmax <= PROFILE_MAX_ARRIVALS)) {
+    ERROR("the rate of %s reaches %lg, too high to generate until T=%lg\n", spec, peak, c->tmax);
+    return -1;
+  }
+  return 0;
+}
+
+// a unit exponential draw, and a uniform one in u
+static double draw(sim_gen_t* g, double* u) {
+  if (g->draw_next == SIM_GEN_BLOCK) {
+    sim_rng_fill_exp(&g->rng, g->draw_exp, SIM_GEN_BLOCK, 1.0);
+    sim_rng_fill_uniform(&g->rng, g->draw_uniform, SIM_GEN_BLOCK);
+    g->draw_next = 0;
+  }
+  *u = g->draw_uniform[g->draw_next];
+  return g->draw_exp[g->draw_next++];
+}
+
+// a tight bound matters for profiles that grow quickly, so time is
+// thinned in segments, each with the bound for its own stretch of time
+#define PROFILE_SEGMENTS 1024
+
+// advance to the next arrival of the nonhomogeneous Poisson process by
+// thinning (Lewis and Shedler): candidates arrive at the bounding rate and
+// each is kept with probability rate(t) / bound
+static bool next_profile_arrival(sim_gen_t* g) {
+  sim_gen_config_t* c = &g->config;
+
+  while (1) {
+    if (g->time >= g->segment_end) {
+      if (g->time >= c->tmax) {
+        return false;
+      }
+      g->segment_end  = fmin(g->time + c->tmax / PROFILE_SEGMENTS, c->tmax);
+      g->segment_rate = profile_bound(c, g->time, g->segment_end);
+    }
+
+    if (g->segment_rate <= 0) {
+      g->time = g->segment_end;
+      continue;
+    }
+
+    double u;
+    double t = g->time + draw(g, &u) / g->segment_rate;
+    if (t >= g->segment_end) {
+      // memoryless, so start again at the next segment
+      g->time = g->segment_end;
+      continue;
+    }
+
+    g->time = t;
+    if (u * g->segment_rate < sim_gen_profile_rate(c, t)) {
+      return true;
+    }
+  }
+}
+
+
+/* Bursty arrivals */
+
+// advance to the next arrival of a Markov-modulated Poisson process
+// In state i, arrivals (rate r_i) and state changes (total rate q_i)
+// race, so the next of either is exponential with rate r_i + q_i
+static bool next_mmpp_arrival(sim_gen_t* g) {
+  sim_gen_config_t* c = &g->config;
+
+  while (1) {
+    double arrival = c->state_rate[g->state];
+    double leave   = 0;
+    for (int j = 0; j < c->num_states; j++) {
+      leave += j == g->state ? 0 : c->state_switch[g->state][j];
+    }
+    if (arrival + leave <= 0) {
+      // an absorbing state with no arrivals
+      return false;
+    }
+
+    double u;
+    g->time += draw(g, &u) / (arrival + leave);
+    if (g->time >= c->tmax) {
+      return false;
+    }
+
+    u *= arrival + leave;
+    if (u < arrival) {
+      return true;
+    }
+
+    // pick the next state in proportion to its switching rate
+    u -= arrival;
+    int j;
+    for (j = 0; j < c->num_states - 1; j++) {
+      double q = j == g->state ? 0 : c->state_switch[g->state][j];
+      if (u < q) {
+        break;
+      }
+      u -= q;
+    }
+    DEBUG("mmpp state %d -> %d at %lf\n", g->state, j, g->time);
+    g->state = j;
+  }
+}
+
+// Pareto(alpha) with the given mean
+static double pareto_period(sim_gen_t* g, double mean) {
+  double alpha = g->config.onoff_alpha;
+  double u;
+  draw(g, &u);
+  return mean * (alpha - 1) / alpha * exp(-log(1.0 - u) / alpha);
+}
+
+// find the next arrival of source s at or after time t
+static void advance_source(sim_gen_t* g, int s, double t) {
+  sim_gen_config_t* c = &g->config;
+  double u;
+
+  while (1) {
+    double next = t + draw(g, &u) / c->on_rate;
+    if (next < g->source_on_end[s]) {
+      g->source_next[s] = next;
+      return;
+    }
+    // the on period ended first: sit out an off period, then start again
+    t = g->source_on_end[s] + pareto_period(g, c->off_mean);
+    g->source_on_end[s] = t + pareto_period(g, c->on_mean);
+  }
+}
+
+// start each source on or off in proportion to the time it spends in each
+static void start_sources(sim_gen_t* g) {
+  sim_gen_config_t* c = &g->config;
+
+  for (int s = 0; s < c->num_sources; s++) {
+    double u;
+    double t = 0;
+    draw(g, &u);
+    if (u >= c->on_mean / (c->on_mean + c->off_mean)) {
+      t = pareto_period(g, c->off_mean);
+    }
+    g->source_on_end[s] = t + pareto_period(g, c->on_mean);
+    advance_source(g, s, t);
+  }
+}
+
+// advance to the next arrival of the superposed on/off sources
+static bool next_onoff_arrival(sim_gen_t* g) {
+  sim_gen_config_t* c = &g->config;
+
+  int first = 0;
+  for (int s = 1; s < c->num_sources; s++) {
+    if (g->source_next[s] < g->source_next[first]) {
+      first = s;
+    }
+  }
+
+  g->time = g->source_next[first];
+  if (g->time >= c->tmax) {
+    return false;
+  }
+
+  advance_source(g, first, g->time);
+  return true;
+}
+
+
+/* Generation */
+
+static void refill(sim_gen_t* g) {
+  sim_gen_config_t* c = &g->config;
+
+  if (c->arrival == SIM_GEN_ARRIVAL_POISSON) {
+    sim_rng_fill_exp(&g->rng, g->interarrival, SIM_GEN_BLOCK, c->mu_arr);
+  }
+
+  if (c->size == SIM_GEN_SIZE_EXP) {
+    sim_rng_fill_exp(&g->rng, g->size, SIM_GEN_BLOCK, c->size_param);
+  } else {
+    sim_rng_fill_pareto(&g->rng, g->size, SIM_GEN_BLOCK, c->size_param);
+  }
+
+  sim_rng_fill_uniform(&g->rng, g->mix, SIM_GEN_BLOCK);
+  sim_rng_fill_uniform(&g->rng, g->param, SIM_GEN_BLOCK);
+  sim_rng_fill_uniform(&g->rng, g->iters, SIM_GEN_BLOCK);
+
+  g->next = 0;
+}
+
+void sim_gen_init(sim_gen_t* g, sim_gen_config_t* config) {
+  memset(g, 0, sizeof(*g));
+  g->config = *config;
+
+  if (!g->config.has_seed) {
+    g->config.seed = ((uint64_t)rand() << 32) ^ rand();
+  }
+  sim_rng_seed(&g->rng, g->config.seed);
+  DEBUG("seed %lu\n", g->config.seed);
+
+  g->next      = SIM_GEN_BLOCK;
+  g->draw_next = SIM_GEN_BLOCK;
+
+  if (g->config.arrival == SIM_GEN_ARRIVAL_ONOFF) {
+    start_sources(g);
+  }
+}
+
+int sim_gen_next(sim_gen_t* g, sim_workload_cmd_t* cmd) {
+  sim_gen_config_t* c = &g->config;
+
+  if (c->arrival == SIM_GEN_ARRIVAL_PROFILE) {
+    if (!next_profile_arrival(g)) {
+      return 0;
+    }
+  } else if (c->arrival == SIM_GEN_ARRIVAL_MMPP) {
+    if (!next_mmpp_arrival(g)) {
+      return 0;
+    }
+  } else if (c->arrival == SIM_GEN_ARRIVAL_ONOFF) {
+    if (!next_onoff_arrival(g)) {
+      return 0;
+    }
+  } else if (g->time >= c->tmax) {
+    // as in Gen.pm, the last arrival is the first one at or after tmax
+    return 0;
+  }
+
+  if (g->next == SIM_GEN_BLOCK) {
+    refill(g);
+  }
+  unsigned i = g->next++;
+
+  if (c->arrival == SIM_GEN_ARRIVAL_POISSON) {
+    g->time += g->interarrival[i];
+  }
+  double size = g->size[i];
+
+  memset(cmd, 0, sizeof(*cmd));
+  cmd->time = sim_time_from_double(g->time);
+  cmd->size = sim_time_from_double(size);
+
+  if (g->mix[i] < c->aperiodic_prob) {
+    cmd->type     = SIM_EVENT_APERIODIC_JOB_ARRIVAL;
+    cmd->priority = c->priority_low + floor(g->param[i] * (c->priority_high - c->priority_low));
+  } else if (g->mix[i] < c->aperiodic_prob + c->sporadic_prob) {
+    double mul    = c->deadline_low + g->param[i] * (c->deadline_high - c->deadline_low);
+    cmd->type     = SIM_EVENT_SPORADIC_JOB_ARRIVAL;
+    cmd->deadline = sim_time_from_double(g->time + size * mul);
+  } else {
+    double mul    = c->period_low + g->param[i] * (c->period_high - c->period_low);
+    cmd->type     = SIM_EVENT_PERIODIC_TASK_ARRIVAL;
+    cmd->period   = sim_time_from_double(size * mul);
+    cmd->numiters = c->iters_low + floor(g->iters[i] * (c->iters_high - c->iters_low));
+  }
+
+  return 1;
+}
@@ -0,0 +1,182 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "simtime.h"
+
+
+// forward declaration to avoid header dependency
+typedef struct sim_workload_cmd sim_workload_cmd_t;
+
+
+// Native version of tools/make_arrivals.pl and tools/Gen.pm
+//
+// A generator produces the arrivals of a synthetic workload one at a time,
+// in time order, so it can feed a simulation directly (as the workload
+// gen:<spec>) or write a text workload (queuesim-generate <spec>)
+// A spec is the arrival process, its parameters, and options:
+//   expexp:mu_arr:mu_size       Poisson arrivals, exponential sizes
+//   exppareto:mu_arr:alpha      Poisson arrivals, Pareto sizes
+// or one of the time-varying contention profiles of Gen.pm, where the
+// profile is the offered load (seconds of work arriving per second) at
+// time t in [0, T), realized as a nonhomogeneous Poisson process
+//   ramp:max[:staytime]         rises linearly to max, then stays there
+//   stepramp:timeinc:max        the same, in steps every timeinc seconds
+//   sawtooth:max:freq           rises to max freq times a second
+//   sine:max:freq               max/2 + max/2 sin(freq t)
+//   exp:tau                     exp(t / tau)
+//   log:rate                    log(e + rate t) - 1
+//   step:start:max              0 before start, max after
+// whose parameters must be positive (staytime and start may also be 0),
+// and whose rate must stay finite until T
+// or one of the bursty processes
+//   mmpp:rates=r1,..,rn:Q=row1/../rown
+//                               Markov-modulated Poisson: arrivals at rate
+//                               ri (per second) while in state i, which
+//                               changes to state j at rate Q[i][j]
+//                               (row i is Q[i][1],..,Q[i][n], the
+//                               diagonal is ignored), starting in state 1
+//   onoff:rate:on:off:alpha     on/off sources with Pareto(alpha) on and
+//                               off periods of mean on and off seconds,
+//                               each with Poisson arrivals at rate while
+//                               on; self-similar for 1 < alpha < 2
+// followed by
+//   :T=secs                     generate arrivals until this time (required)
+//   :seed=int                   random number seed (default from rand())
+//   :size=mean                  exponential sizes (default 1), except for
+//                               expexp and exppareto
+//   :alpha=a                    Pareto sizes instead
+//   :sources=n                  number of on/off sources (default 1)
+// for example expexp:1:0.5:T=1e6 or sine:0.8:0.01:T=1e5:alpha=2.5
+//
+// Each arrival becomes an aperiodic job, sporadic job, or periodic task
+// using the same mix as make_arrivals.pl, taken from the same environment
+// variables: APERIODIC=p:l:u, SPORADIC=p:a:b, PERIODIC=p:a:b:c:d
+
+typedef enum {
+  SIM_GEN_ARRIVAL_POISSON,
+  SIM_GEN_ARRIVAL_PROFILE,
+  SIM_GEN_ARRIVAL_MMPP,
+  SIM_GEN_ARRIVAL_ONOFF,
+} sim_gen_arrival_t;
+
+#define SIM_GEN_MAX_STATES  8
+#define SIM_GEN_MAX_SOURCES 64
+
+typedef enum {
+  SIM_GEN_PROFILE_RAMP,
+  SIM_GEN_PROFILE_STEP_RAMP,
+  SIM_GEN_PROFILE_SAWTOOTH,
+  SIM_GEN_PROFILE_SINE,
+  SIM_GEN_PROFILE_EXP,
+  SIM_GEN_PROFILE_LOG,
+  SIM_GEN_PROFILE_STEP,
+} sim_gen_profile_t;
+
+typedef enum {
+  SIM_GEN_SIZE_EXP,
+  SIM_GEN_SIZE_PARETO,
+} sim_gen_size_t;
+
+typedef struct sim_gen_config {
+  sim_gen_arrival_t arrival;
+  double mu_arr;        // mean interarrival time
+  sim_gen_profile_t profile;
+  double profile_param[2];
+  double profile_end;   // end of the varying part (T, ramp stays after)
+
+  // Markov-modulated Poisson
+  int num_states;
+  double state_rate[SIM_GEN_MAX_STATES];
+  double state_switch[SIM_GEN_MAX_STATES][SIM_GEN_MAX_STATES];
+
+  // on/off sources
+  int num_sources;
+  double on_rate;
+  double on_mean, off_mean, onoff_alpha;
+
+  sim_gen_size_t size;
+  double size_param;    // mean (exponential) or alpha (Pareto)
+  double tmax;          // last arrival is the first at or after tmax
+  uint64_t seed;
+  bool has_seed;
+
+  // job mix, as in make_arrivals.pl
+  double aperiodic_prob;
+  double priority_low, priority_high;
+  double sporadic_prob;
+  double deadline_low, deadline_high;     // multiples of size
+  double periodic_prob;
+  double period_low, period_high;         // multiples of size
+  double iters_low, iters_high;
+} sim_gen_config_t;
+
+// xoshiro256** random number generator
+typedef struct sim_rng {
+  uint64_t s[4];
+} sim_rng_t;
+
+// random numbers are drawn a block at a time
+#define SIM_GEN_BLOCK 256
+
+typedef struct sim_gen {
+  sim_gen_config_t config;
+  sim_rng_t rng;
+  double time;          // time of the last arrival
+
+  // thinning: the current segment of time and the bound on its rate
+  double segment_end;
+  double segment_rate;
+
+  // Markov-modulated Poisson: the current state
+  int state;
+
+  // on/off sources: the next arrival of each, and the end of its on period
+  double source_next[SIM_GEN_MAX_SOURCES];
+  double source_on_end[SIM_GEN_MAX_SOURCES];
+
+  // the current block of draws, each used once
+  unsigned next;
+  double interarrival[SIM_GEN_BLOCK];
+  double size[SIM_GEN_BLOCK];
+  double mix[SIM_GEN_BLOCK];
+  double param[SIM_GEN_BLOCK];
+  double iters[SIM_GEN_BLOCK];
+
+  // draws for the arrival processes, used as needed
+  unsigned draw_next;
+  double draw_exp[SIM_GEN_BLOCK];
+  double draw_uniform[SIM_GEN_BLOCK];
+} sim_gen_t;
+
+
+// defaults, with the job mix from the environment
+int  sim_gen_config_init(sim_gen_config_t* config);
+// parse a spec (without the gen: prefix) into config
+int  sim_gen_config_parse(sim_gen_config_t* config, const char* spec);
+
+void sim_gen_init(sim_gen_t* gen, sim_gen_config_t* config);
+
+// produce the next arrival: 1 if there is one, 0 after tmax
+int  sim_gen_next(sim_gen_t* gen, sim_workload_cmd_t* cmd);
+
+// arrival rate (per second) of a profile at time t
+double sim_gen_profile_rate(sim_gen_config_t* config, double t);
+
+
+void   sim_rng_seed(sim_rng_t* rng, uint64_t seed);
+// uniform in [0, 1)
+double sim_rng_uniform(sim_rng_t* rng);
+
+// fill out with n draws from a distribution
+void sim_rng_fill_uniform(sim_rng_t* rng, double* out, unsigned n);
+void sim_rng_fill_exp(sim_rng_t* rng, double* out, unsigned n, double mean);
+void sim_rng_fill_pareto(sim_rng_t* rng, double* out, unsigned n, double alpha);
@@ -35,14 +35,14 @@ static uint64_t current_job_id = 0;
 // initialize an already allocated job
 static void sim_job_init(sim_job_t*     job,
                          sim_job_type_t type,
-                         double         arrival_time,
-                         double         size,
-                         double         remaining_size,
+                         sim_time_t     arrival_time,
+                         sim_time_t     size,
+                         sim_time_t     remaining_size,
                          uint64_t       static_priority,
                          uint64_t       dynamic_priority,
-                         double         period,
+                         sim_time_t     period,
                          uint64_t       numiters,
-                         double         deadline) {
+                         sim_time_t     deadline) {
 
   memset(job, 0, sizeof(*job));
 
@@ -66,16 +66,16 @@ static void sim_job_init(sim_job_t*     job,
 /* Public functions */
 
 sim_job_t* sim_job_create(sim_job_type_t type,
-                          double         arrival_time,
-                          double         size,
-                          double         remaining_size,
+                          sim_time_t     arrival_time,
+                          sim_time_t     size,
+                          sim_time_t     remaining_size,
                           uint64_t       static_priority,
                           uint64_t       dynamic_priority,
-                          double         period,
+                          sim_time_t     period,
                           uint64_t       numiters,
-                          double         deadline) {
+                          sim_time_t     deadline) {
 
-  sim_job_t* job = malloc(sizeof(*job));
+  sim_job_t* job = aligned_alloc(SIM_JOB_ALIGN, sizeof(*job));
   if (!job) {
     ERROR("cannot allocate job\n");
     return NULL;
@@ -110,22 +110,28 @@ int sim_job_complete(sim_context_t* context,
 
       // event either fires in the future when it's supposed to
       // or right now if we already passed that time
-      double event_time = sim_context_get_current_time(context);
+      sim_time_t event_time = sim_context_get_current_time(context);
       if (event_time < job->arrival_time) {
         event_time = job->arrival_time;
       }
 
-      sim_event_t* e = sim_event_create(event_time,
-                                        context,
-                                        SIM_EVENT_PERIODIC_TASK_ARRIVAL,
-                                        job);
+      // tasks normally arrive with their arrival event already attached,
+      // but create one here if this task was built some other way
+      if (!job->arrival_event) {
+        sim_event_t* e = sim_event_create(event_time,
+                                          SIM_EVENT_PERIODIC_TASK_ARRIVAL,
+                                          job);
 
-      if (!e) {
-        ERROR("failed to allocate event\n");
-        return -1;
+        if (!e) {
+          ERROR("failed to allocate event\n");
+          return -1;
+        }
+
+        sim_job_attach_arrival_event(job, e);
       }
 
-      sim_event_queue_post(&context->event_queue, e);
+      // re-arm the same event for the next period
+      sim_event_queue_reschedule(&context->event_queue, job->arrival_event, event_time, job);
     }
   } else {
     sim_job_destroy(job);
@@ -134,22 +140,34 @@ int sim_job_complete(sim_context_t* context,
   return 0;
 }
 
+void sim_job_attach_arrival_event(sim_job_t* job, sim_event_t* e) {
+  e->embedded        = true;
+  job->arrival_event = e;
+}
+
 void sim_job_destroy(sim_job_t* job) {
+  free(job->arrival_event);
   free(job);
 }
 
 void sim_job_print(sim_job_t* job, FILE* f) {
   fprintf(f, "job %lu arrival %lf size %lf remaining size %lf ",
-          job->id, job->arrival_time, job->size, job->remaining_size);
+          job->id,
+          sim_time_to_double(job->arrival_time),
+          sim_time_to_double(job->size),
+          sim_time_to_double(job->remaining_size));
 
   switch (job->type) {
     case SIM_JOB_PERIODIC:
       fprintf(f, "periodic deadline %lf period %lf numiters %lu %s",
-              job->deadline, job->period, job->numiters, job->first_arrival ? "first" : "");
+              sim_time_to_double(job->deadline),
+              sim_time_to_double(job->period),
+              job->numiters,
+              job->first_arrival ? "first" : "");
       break;
 
     case SIM_JOB_SPORADIC:
-      fprintf(f, "sporadic deadline %lf", job->deadline);
+      fprintf(f, "sporadic deadline %lf", sim_time_to_double(job->deadline));
       break;
 
     case SIM_JOB_APERIODIC:
@@ -159,7 +177,7 @@ void sim_job_print(sim_job_t* job, FILE* f) {
   }
 }
 
-void sim_job_set_remaining_size(sim_job_t* job, double remaining_size) {
+void sim_job_set_remaining_size(sim_job_t* job, sim_time_t remaining_size) {
   job->remaining_size = remaining_size;
 }
 
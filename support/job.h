@@ -12,12 +12,17 @@
 #include <stdlib.h>
 
 #include "list.h"
+#include "simtime.h"
 
 
 // forward declaration of to avoid header dependency
 typedef struct sim_context sim_context_t;
+typedef struct sim_event sim_event_t;
 
 
+// jobs are aligned to (and their hot fields fit in) one cache line
+#define SIM_JOB_ALIGN 64
+
 typedef enum {
   SIM_JOB_PERIODIC,  // realtime jobs that recur
   SIM_JOB_SPORADIC,  // realtime jobs that run once only
@@ -27,54 +32,65 @@ typedef enum {
 // a job contains information from all kinds of jobs/tasks, some of which may
 //  not be relevant for the given job type
 // nothing in this struct may be modified by schedulers
+// the fields used while walking and ordering job queues are packed into
+// the first cache line, and jobs are allocated cache line aligned
 typedef struct sim_job {
-  uint64_t id;
-  sim_job_type_t type;
-
-  // information that is valid for all jobs
-  double arrival_time;
-  double size;
-  uint64_t static_priority; // higher number implies higher priority
+  // this allows you to put the job into a job queue
+  // it can only be in one job queue at a time
+  struct list_head node;
 
   // bookkeeping variables for scheduler use
   // these may both be modified by the scheduler as desired
   // the values of these variables have no affect on the simulation
-  double remaining_size; // modified with sim_job_set_remaining_size()
+  sim_time_t remaining_size; // modified with sim_job_set_remaining_size()
   uint64_t dynamic_priority; // modified with sim_job_set_dynamic_priority()
 
+  // information that is valid for all jobs
+  // all times and sizes are in simulated time ticks (see simtime.h)
+  uint64_t static_priority; // higher number implies higher priority
+  sim_time_t size;
+  sim_time_t arrival_time;
+  sim_job_type_t type;
+
+  // everything below here is rarely touched (second cache line)
+  uint64_t id;
+
   // information that is valid for periodic or sporadic
   // real-time jobs
-  double deadline;
+  sim_time_t deadline;
 
   // information that is valid for periodic real-time jobs
   // numiters is the number of times the job will re-arrive
-  double period;
+  sim_time_t period;
   uint64_t numiters;
   bool first_arrival;
 
-  // this allows you to put the job into a job queue
-  // it can only be in one job queue at a time
-  struct list_head node;
-
-} sim_job_t;
+  // the arrival event a periodic task re-arms for each period
+  // owned by the job and freed when the job is destroyed
+  sim_event_t* arrival_event;
+} __attribute__((aligned(SIM_JOB_ALIGN))) sim_job_t;
 
 
 // allocate and initialize a job
 sim_job_t* sim_job_create(sim_job_type_t type,
-                          double         arr_time,
-                          double         size,
-                          double         remaining_size,
+                          sim_time_t     arr_time,
+                          sim_time_t     size,
+                          sim_time_t     remaining_size,
                           uint64_t       static_priority,
                           uint64_t       dynamic_priority,
-                          double         period,
+                          sim_time_t     period,
                           uint64_t       numiters,
-                          double         deadline);
+                          sim_time_t     deadline);
 
 // call on job completion - will regenerate periodic job
 int sim_job_complete(sim_context_t* context,
                      sim_job_t*     job);
 
 
+// hand ownership of a periodic task's arrival event to the task
+// the simulation will no longer free the event after it is dispatched
+void sim_job_attach_arrival_event(sim_job_t* job, sim_event_t* event);
+
 // the only way to delete a job - it must already be removed from any queue
 void sim_job_destroy(sim_job_t* job);
 
@@ -82,7 +98,7 @@ void sim_job_destroy(sim_job_t* job);
 void sim_job_print(sim_job_t* job, FILE* f);
 
 // modify the remaining size of the job
-void sim_job_set_remaining_size(sim_job_t* job, double remaining_size);
+void sim_job_set_remaining_size(sim_job_t* job, sim_time_t remaining_size);
 
 // modify the dynamic priority of the job
 void sim_job_set_dynamic_priority(sim_job_t* job, uint64_t dynamic_priority);
@@ -26,13 +26,8 @@
 
 /* Internal helper functions */
 
-static int total_time(void* state, sim_job_t* job) {
-  *(double*)state += job->size;
-  return 0;
-}
-
 static int total_remaining_time(void* state, sim_job_t* job) {
-  *(double*)state += job->remaining_size;
+  *(sim_time_t*)state += job->remaining_size;
   return 0;
 }
 
@@ -47,16 +42,19 @@ void sim_job_queue_init(sim_job_queue_t* jq) {
 void sim_job_queue_enqueue(sim_job_queue_t* jq, sim_job_t* job) {
   list_add_tail(&job->node, &jq->list);
   jq->num_jobs++;
+  jq->total_size += job->size;
 }
 
 void sim_job_queue_enqueue_before(sim_job_queue_t* jq, sim_job_t* job, sim_job_t* target) {
   list_add(&job->node, &target->node);
   jq->num_jobs++;
+  jq->total_size += job->size;
 }
 
 void sim_job_queue_enqueue_after(sim_job_queue_t* jq, sim_job_t* job, sim_job_t* target) {
   list_add_tail(&job->node, &target->node);
   jq->num_jobs++;
+  jq->total_size += job->size;
 }
 
 void sim_job_queue_enqueue_in_order(sim_job_queue_t* jq,
@@ -66,6 +64,7 @@ void sim_job_queue_enqueue_in_order(sim_job_queue_t* jq,
   if (list_empty(&jq->list)) {
     list_add(&job->node, &jq->list);
     jq->num_jobs++;
+    jq->total_size += job->size;
     return;
   }
 
@@ -78,6 +77,7 @@ void sim_job_queue_enqueue_in_order(sim_job_queue_t* jq,
       // insert before this node
       list_add_tail(&job->node, cur);
       jq->num_jobs++;
+      jq->total_size += job->size;
       return;
     }
   }
@@ -85,6 +85,7 @@ void sim_job_queue_enqueue_in_order(sim_job_queue_t* jq,
   // if we got here, we need to put it the end
   list_add_tail(&job->node, &jq->list);
   jq->num_jobs++;
+  jq->total_size += job->size;
 }
 
 sim_job_t* sim_job_queue_peek(sim_job_queue_t* jq) {
@@ -108,6 +109,7 @@ sim_job_t* sim_job_queue_dequeue(sim_job_queue_t* jq) {
 void sim_job_queue_remove(sim_job_queue_t* jq, sim_job_t* j) {
   list_del_init(&j->node);
   jq->num_jobs--;
+  jq->total_size -= j->size;
 }
 
 sim_job_t* sim_job_queue_search(sim_job_queue_t* jq,
@@ -137,14 +139,12 @@ int sim_job_queue_map(sim_job_queue_t* jq,
   return rc;
 }
 
-double sim_job_queue_get_total_time(sim_job_queue_t* jq) {
-  double sum = 0;
-  sim_job_queue_map(jq, total_time, (void*)&sum);
-  return sum;
+sim_time_t sim_job_queue_get_total_time(sim_job_queue_t* jq) {
+  return jq->total_size;
 }
 
-double sim_job_queue_get_total_remaining_time(sim_job_queue_t* jq) {
-  double sum = 0;
+sim_time_t sim_job_queue_get_total_remaining_time(sim_job_queue_t* jq) {
+  sim_time_t sum = 0;
   sim_job_queue_map(jq, total_remaining_time, (void*)&sum);
   return sum;
 }
@@ -12,6 +12,7 @@
 
 #include "job.h"
 #include "list.h"
+#include "simtime.h"
 
 
 // forward declaration to avoid header dependency
@@ -19,8 +20,9 @@ typedef struct sim_job sim_job_t;
 
 // nothing in this struct may be modified by schedulers
 typedef struct sim_job_queue {
-  // total number of jobs in the queue
+  // total number of jobs in the queue, and the sum of their sizes
   uint64_t num_jobs;
+  sim_time_t total_size;
 
   struct list_head list;
 } sim_job_queue_t;
@@ -72,11 +74,11 @@ int sim_job_queue_map(sim_job_queue_t* jq,
                       int (* func)(void* state, sim_job_t* job),
                       void* state);
 
-// get total time to complete all jobs in queue
-double sim_job_queue_get_total_time(sim_job_queue_t* jq);
+// get total time to complete all jobs in queue (kept as jobs come and go)
+sim_time_t sim_job_queue_get_total_time(sim_job_queue_t* jq);
 
 // get total remaining to complete all jobs in queue
-double sim_job_queue_get_total_remaining_time(sim_job_queue_t* jq);
+sim_time_t sim_job_queue_get_total_remaining_time(sim_job_queue_t* jq);
 
 // print all contents of the job queue
 void sim_job_queue_print(sim_job_queue_t* jq, FILE* f);
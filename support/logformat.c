@@ -0,0 +1,900 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "debug.h"
+#include "job.h"
+#include "logformat.h"
+#include "profile.h"
+
+
+// control debugging prints throughout this file
+#if DEBUG_LOG_FORMAT
+#define DEBUG(fmt, args...) DEBUG_PRINT("logformat: " fmt, ##args)
+#else
+#define DEBUG(fmt, args...)
+#endif
+#define ERROR(fmt, args...) ERROR_PRINT("logformat: " fmt, ##args)
+#define INFO(fmt, args...)  INFO_PRINT("logformat: " fmt, ##args)
+
+
+/* Internal helper functions */
+
+// fixed-width little-endian header fields regardless of host byte order
+static void put_u64(uint8_t* p, uint64_t v) {
+  for (int i = 0; i < 8; i++) {
+    p[i] = v >> (8 * i);
+  }
+}
+
+static uint64_t get_u64(uint8_t* p) {
+  uint64_t v = 0;
+  for (int i = 0; i < 8; i++) {
+    v |= (uint64_t)p[i] << (8 * i);
+  }
+  return v;
+}
+
+static void put_u16(uint8_t* p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+static uint16_t get_u16(uint8_t* p) {
+  return p[0] | (p[1] << 8);
+}
+
+// LEB128 varints for record fields, returning the number of bytes used
+static int put_varint(uint8_t* p, uint64_t v) {
+  int n = 0;
+  while (v >= 0x80) {
+    p[n++] = (v & 0x7f) | 0x80;
+    v >>= 7;
+  }
+  p[n++] = v;
+  return n;
+}
+
+static int put_zigzag(uint8_t* p, int64_t v) {
+  return put_varint(p, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+// returns -1 at end of file
+static int get_varint(FILE* f, uint64_t* v) {
+  *v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int c = getc_unlocked(f);
+    if (c == EOF) {
+      return -1;
+    }
+    *v |= (uint64_t)(c & 0x7f) << shift;
+    if (!(c & 0x80)) {
+      return 0;
+    }
+  }
+  return -1;
+}
+
+static int put_double(uint8_t* p, double d) {
+  uint64_t v;
+  memcpy(&v, &d, sizeof(v));
+  put_u64(p, v);
+  return 8;
+}
+
+static int get_double(FILE* f, double* d) {
+  uint8_t b[8];
+  if (fread(b, 1, sizeof(b), f) != sizeof(b)) {
+    return -1;
+  }
+  uint64_t v = get_u64(b);
+  memcpy(d, &v, sizeof(v));
+  return 0;
+}
+
+static int get_zigzag(FILE* f, int64_t* v) {
+  uint64_t u;
+  if (get_varint(f, &u)) {
+    return -1;
+  }
+  *v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+  return 0;
+}
+
+static char* job_type_name(sim_job_t* job) {
+  return job->type == SIM_JOB_APERIODIC ? "APERIODIC" :
+         job->type == SIM_JOB_SPORADIC  ? "SPORADIC" :
+         "PERIODIC";
+}
+
+static char* record_type_name(sim_log_record_type_t type) {
+  return type == SIM_LOG_JOB_ARRIVAL   ? "JOB_ARRIVAL" :
+         type == SIM_LOG_TASK_ARRIVAL  ? "TASK_ARRIVAL" :
+         type == SIM_LOG_TASK_ACCEPTED ? "TASK_ACCEPTED" :
+         type == SIM_LOG_TASK_REJECTED ? "TASK_REJECTED" :
+         type == SIM_LOG_JOB_ACCEPTED  ? "JOB_ACCEPTED" :
+         type == SIM_LOG_JOB_REJECTED  ? "JOB_REJECTED" :
+         type == SIM_LOG_JOB_DONE      ? "JOB_DONE" :
+         type == SIM_LOG_TIMER         ? "TIMER" :
+         "UNKNOWN";
+}
+
+// print the text line for a completed job in the jobs log
+static void print_job_done(FILE* f, sim_time_t time, sim_job_t* job) {
+  double turnaroundtime = sim_time_to_double(time - job->arrival_time);
+  double slowdown       = turnaroundtime / sim_time_to_double(job->size);
+  bool missed           = job->type != SIM_JOB_APERIODIC && job->deadline < time;
+
+  if (job->type == SIM_JOB_APERIODIC) {
+    fprintf(f, "%lf APERIODIC %lf %lf %lf # ",
+            sim_time_to_double(time),
+            sim_time_to_double(job->size),
+            turnaroundtime,
+            slowdown);
+  } else if (job->type == SIM_JOB_SPORADIC) {
+    fprintf(f, "%lf %s %lf %lf %lf %lf # ",
+            sim_time_to_double(time),
+            missed ? "SPORADIC_MISS" : "SPORADIC_HIT",
+            sim_time_to_double(job->size),
+            turnaroundtime,
+            slowdown,
+            sim_time_to_double(job->deadline));
+  } else {
+    fprintf(f, "%lf %s %lf %lf %lf %lf # ",
+            sim_time_to_double(time),
+            missed ? "PERIODIC_MISS" : "PERIODIC_HIT",
+            sim_time_to_double(job->size),
+            turnaroundtime,
+            slowdown,
+            sim_time_to_double(job->deadline));
+  }
+  sim_job_print(job, f);
+  fprintf(f, "\n");
+}
+
+
+// add the queue state q, in effect for duration ticks, to the summary
+static void sampler_accumulate(sim_log_sampler_t* s, sim_log_queuelen_t* q, sim_time_t duration) {
+  sim_log_queuelen_summary_t* sum = &s->sum;
+  double dt = duration;
+
+  sum->duration            += duration;
+  sum->realtime_jobs       += q->realtime_jobs * dt;
+  sum->realtime_total      += q->realtime_total * dt;
+  sum->realtime_remaining  += q->realtime_remaining * dt;
+  sum->aperiodic_jobs      += q->aperiodic_jobs * dt;
+  sum->aperiodic_total     += q->aperiodic_total * dt;
+  sum->aperiodic_remaining += q->aperiodic_remaining * dt;
+
+  if (duration > 0) {
+    if (q->realtime_jobs > sum->realtime_max_jobs) {
+      sum->realtime_max_jobs = q->realtime_jobs;
+    }
+    if (q->aperiodic_jobs > sum->aperiodic_max_jobs) {
+      sum->aperiodic_max_jobs = q->aperiodic_jobs;
+    }
+  }
+}
+
+// turn the integrals into means, write them out, and start a new interval
+static void sampler_emit_summary(sim_log_sampler_t* s, sim_log_sink_t* sink, sim_time_t time) {
+  sim_log_queuelen_summary_t* sum = &s->sum;
+
+  if (sum->duration > 0) {
+    double ticks  = sum->duration;
+    double tsecs  = ticks * SIM_TIME_TICKS_PER_SEC;
+    sum->time                 = time;
+    sum->realtime_jobs       /= ticks;
+    sum->realtime_total      /= tsecs;
+    sum->realtime_remaining  /= tsecs;
+    sum->aperiodic_jobs      /= ticks;
+    sum->aperiodic_total     /= tsecs;
+    sum->aperiodic_remaining /= tsecs;
+    sim_log_write_queuelen_summary(sink, sum);
+  }
+
+  memset(sum, 0, sizeof(*sum));
+}
+
+// add the queue state q, in effect for duration ticks, to the window
+static void windower_accumulate(sim_log_windower_t* w, sim_log_queuelen_t* q, sim_time_t duration) {
+  sim_log_window_t* sum = &w->sum;
+  uint64_t jobs = q->realtime_jobs + q->aperiodic_jobs;
+
+  sum->duration += duration;
+  sum->jobs     += jobs * (double)duration;
+
+  if (duration > 0 && jobs > 0) {
+    sum->busy += duration;
+    if (jobs > sum->max_jobs) {
+      sum->max_jobs = jobs;
+    }
+  }
+}
+
+// finish the window, write it out, and start the next one
+static void windower_emit(sim_log_windower_t* w, sim_log_sink_t* sink, sim_time_t time) {
+  sim_log_window_t* sum = &w->sum;
+
+  if (sum->duration > 0) {
+    sum->time            = time;
+    sum->jobs           /= sum->duration;
+    sum->turnaround      = sim_accumulator_mean(&w->turnaround);
+    sum->turnaround_p99  = sim_histogram_quantile(&w->turnaround_hist, 0.99);
+    sim_log_write_window(sink, sum);
+  }
+
+  memset(sum, 0, sizeof(*sum));
+  sim_accumulator_init(&w->turnaround);
+  sim_histogram_init(&w->turnaround_hist);
+}
+
+
+/* Public functions */
+
+void sim_log_config_init(sim_log_config_t* config) {
+  memset(config, 0, sizeof(*config));
+  config->format        = SIM_LOG_TEXT;
+  config->queuelen      = true;
+  config->events        = true;
+  config->jobs          = true;
+  config->trace         = true;
+  config->queuelen_mode = SIM_LOG_SAMPLE_EVERY_EVENT;
+  config->trace_mode    = SIM_TRACE_RING;
+  config->trace_size    = SIM_TRACE_DEFAULT_SIZE;
+}
+
+int sim_log_config_parse_logs(sim_log_config_t* config, char* spec) {
+  char buf[256];
+  snprintf(buf, sizeof(buf), "%s", spec);
+
+  config->queuelen = config->events = config->jobs = config->trace = false;
+
+  char* save = NULL;
+  for (char* tok = strtok_r(buf, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+    if (!strcasecmp(tok, "queuelen")) {
+      config->queuelen = true;
+    } else if (!strcasecmp(tok, "events")) {
+      config->events = true;
+    } else if (!strcasecmp(tok, "jobs")) {
+      config->jobs = true;
+    } else if (!strcasecmp(tok, "trace")) {
+      config->trace = true;
+    } else if (!strcasecmp(tok, "all")) {
+      config->queuelen = config->events = config->jobs = config->trace = true;
+    } else if (strcasecmp(tok, "none")) {
+      ERROR("unknown log %s\n", tok);
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+int sim_log_config_parse_queuelen(sim_log_config_t* config, char* spec) {
+  double interval = 0;
+
+  if (!strcasecmp(spec, "event")) {
+    config->queuelen_mode = SIM_LOG_SAMPLE_EVERY_EVENT;
+    return 0;
+  }
+
+  if (sscanf(spec, "sample:%lf", &interval) == 1) {
+    config->queuelen_mode = SIM_LOG_SAMPLE_INTERVAL;
+  } else if (sscanf(spec, "summary:%lf", &interval) == 1) {
+    config->queuelen_mode = SIM_LOG_SAMPLE_SUMMARY;
+  } else {
+    ERROR("unknown queue length mode %s\n", spec);
+    return -1;
+  }
+
+  config->queuelen_interval = sim_time_from_double(interval);
+  if (config->queuelen_interval <= 0) {
+    ERROR("queue length interval must be positive\n");
+    return -1;
+  }
+
+  return 0;
+}
+
+int sim_log_config_parse_window(sim_log_config_t* config, char* spec) {
+  char* end;
+  double interval = strtod(spec, &end);
+
+  if (end == spec || *end) {
+    ERROR("unknown window length %s\n", spec);
+    return -1;
+  }
+
+  config->window_interval = sim_time_from_double(interval);
+  if (config->window_interval <= 0) {
+    ERROR("window length must be positive\n");
+    return -1;
+  }
+
+  return 0;
+}
+
+int sim_log_config_parse_trace(sim_log_config_t* config, char* spec) {
+  uint64_t size = 0;
+
+  if (!strcasecmp(spec, "ring")) {
+    config->trace_mode = SIM_TRACE_RING;
+  } else if (sscanf(spec, "ring:%lu", &size) == 1 && size > 0) {
+    config->trace_mode = SIM_TRACE_RING;
+    config->trace_size = size;
+  } else if (!strcasecmp(spec, "stderr")) {
+    config->trace_mode = SIM_TRACE_STDERR;
+  } else if (!strcasecmp(spec, "off")) {
+    config->trace_mode = SIM_TRACE_OFF;
+  } else {
+    ERROR("unknown trace mode %s\n", spec);
+    return -1;
+  }
+
+  return 0;
+}
+
+int sim_log_sink_open(sim_log_sink_t*   sink,
+                      sim_log_writer_t* writer,
+                      char*             path,
+                      sim_log_kind_t    kind,
+                      sim_log_format_t  format) {
+  memset(sink, 0, sizeof(*sink));
+  sink->kind   = kind;
+  sink->format = format;
+
+  if (!(sink->file = sim_log_writer_open(writer, path))) {
+    return -1;
+  }
+
+  if (format == SIM_LOG_BINARY) {
+    uint8_t h[SIM_LOG_HEADER_SIZE] = {0};
+    memcpy(h, SIM_LOG_MAGIC, sizeof(SIM_LOG_MAGIC));
+    put_u16(h + 8, SIM_LOG_VERSION);
+    put_u16(h + 10, kind);
+    put_u64(h + 16, SIM_TIME_TICKS_PER_SEC);
+    fwrite(h, 1, sizeof(h), sink->file);
+  }
+
+  return 0;
+}
+
+void sim_log_sink_close(sim_log_sink_t* sink) {
+  if (sink->file) {
+    fclose(sink->file);
+    sink->file = NULL;
+  }
+}
+
+void sim_log_write_queuelen(sim_log_sink_t* sink, sim_log_queuelen_t* q) {
+  if (!sink->file) {
+    return;
+  }
+  SIM_PROFILE_BEGIN(start);
+  if (sink->format == SIM_LOG_TEXT) {
+    sim_log_print_queuelen(sink->file, q);
+    SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+    return;
+  }
+
+  uint8_t r[SIM_LOG_MAX_RECORD_SIZE];
+  int n = 0;
+  n += put_zigzag(r + n, q->time - sink->last_time);
+  n += put_varint(r + n, q->realtime_jobs);
+  n += put_zigzag(r + n, q->realtime_total);
+  n += put_zigzag(r + n, q->realtime_remaining);
+  n += put_varint(r + n, q->aperiodic_jobs);
+  n += put_zigzag(r + n, q->aperiodic_total);
+  n += put_zigzag(r + n, q->aperiodic_remaining);
+  fwrite(r, 1, n, sink->file);
+
+  sink->last_time = q->time;
+
+  SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+}
+
+void sim_log_write_job(sim_log_sink_t*       sink,
+                       sim_time_t            time,
+                       sim_log_record_type_t type,
+                       sim_job_t*            job) {
+  if (!sink->file) {
+    return;
+  }
+  SIM_PROFILE_BEGIN(start);
+  if (sink->format == SIM_LOG_TEXT) {
+    sim_log_print_job(sink->file, sink->kind, time, type, job);
+    SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+    return;
+  }
+
+  uint8_t r[SIM_LOG_MAX_RECORD_SIZE];
+  int n = 0;
+  n += put_zigzag(r + n, time - sink->last_time);
+  r[n++] = type;
+  if (job) {
+    r[n++] = job->type | (job->first_arrival << 4);
+    n += put_varint(r + n, job->id);
+    n += put_zigzag(r + n, time - job->arrival_time);
+    n += put_zigzag(r + n, job->size);
+    n += put_zigzag(r + n, job->remaining_size);
+    n += put_zigzag(r + n, job->deadline);
+    n += put_zigzag(r + n, job->period);
+    n += put_varint(r + n, job->static_priority);
+    n += put_varint(r + n, job->dynamic_priority);
+    n += put_varint(r + n, job->numiters);
+  }
+  fwrite(r, 1, n, sink->file);
+
+  sink->last_time = time;
+
+  SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+}
+
+void sim_log_write_queuelen_summary(sim_log_sink_t* sink, sim_log_queuelen_summary_t* q) {
+  if (!sink->file) {
+    return;
+  }
+  SIM_PROFILE_BEGIN(start);
+  if (sink->format == SIM_LOG_TEXT) {
+    sim_log_print_queuelen_summary(sink->file, q);
+    SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+    return;
+  }
+
+  uint8_t r[SIM_LOG_MAX_RECORD_SIZE];
+  int n = 0;
+  n += put_zigzag(r + n, q->time - sink->last_time);
+  n += put_zigzag(r + n, q->duration);
+  n += put_double(r + n, q->realtime_jobs);
+  n += put_double(r + n, q->realtime_total);
+  n += put_double(r + n, q->realtime_remaining);
+  n += put_double(r + n, q->aperiodic_jobs);
+  n += put_double(r + n, q->aperiodic_total);
+  n += put_double(r + n, q->aperiodic_remaining);
+  n += put_varint(r + n, q->realtime_max_jobs);
+  n += put_varint(r + n, q->aperiodic_max_jobs);
+  fwrite(r, 1, n, sink->file);
+
+  sink->last_time = q->time;
+
+  SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+}
+
+void sim_log_write_window(sim_log_sink_t* sink, sim_log_window_t* w) {
+  if (!sink->file) {
+    return;
+  }
+  SIM_PROFILE_BEGIN(start);
+  if (sink->format == SIM_LOG_TEXT) {
+    sim_log_print_window(sink->file, w);
+    SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+    return;
+  }
+
+  uint8_t r[SIM_LOG_MAX_RECORD_SIZE];
+  int n = 0;
+  n += put_zigzag(r + n, w->time - sink->last_time);
+  n += put_zigzag(r + n, w->duration);
+  n += put_varint(r + n, w->completions);
+  n += put_zigzag(r + n, w->busy);
+  n += put_double(r + n, w->jobs);
+  n += put_varint(r + n, w->max_jobs);
+  n += put_double(r + n, w->turnaround);
+  n += put_double(r + n, w->turnaround_p99);
+  fwrite(r, 1, n, sink->file);
+
+  sink->last_time = w->time;
+
+  SIM_PROFILE_END(start, SIM_PROFILE_LOG_WRITE);
+}
+
+void sim_log_sampler_init(sim_log_sampler_t* s, sim_log_queuelen_mode_t mode, sim_time_t interval) {
+  memset(s, 0, sizeof(*s));
+  s->mode     = mode;
+  s->interval = interval;
+  s->next     = interval;
+}
+
+bool sim_log_sampler_due(sim_log_sampler_t* s, sim_time_t time) {
+  switch (s->mode) {
+    case SIM_LOG_SAMPLE_INTERVAL:
+      return time > s->next;
+    case SIM_LOG_SAMPLE_SUMMARY:
+      return time > s->last;
+    default:
+      return false;
+  }
+}
+
+void sim_log_sampler_advance(sim_log_sampler_t*  s,
+                             sim_log_sink_t*     sink,
+                             sim_log_queuelen_t* q,
+                             sim_time_t          time) {
+  if (s->mode == SIM_LOG_SAMPLE_INTERVAL) {
+    // a sample at a boundary is written once time has moved past it,
+    // so that it reflects every event at the boundary itself
+    while (s->next < time) {
+      q->time = s->next;
+      sim_log_write_queuelen(sink, q);
+      s->next += s->interval;
+    }
+  } else if (s->mode == SIM_LOG_SAMPLE_SUMMARY) {
+    while (s->next <= time) {
+      sampler_accumulate(s, q, s->next - s->last);
+      sampler_emit_summary(s, sink, s->next);
+      s->last  = s->next;
+      s->next += s->interval;
+    }
+    sampler_accumulate(s, q, time - s->last);
+  }
+  s->last = time;
+}
+
+void sim_log_sampler_finish(sim_log_sampler_t*  s,
+                            sim_log_sink_t*     sink,
+                            sim_log_queuelen_t* q,
+                            sim_time_t          time) {
+  if (s->mode == SIM_LOG_SAMPLE_INTERVAL) {
+    while (s->next <= time) {
+      q->time = s->next;
+      sim_log_write_queuelen(sink, q);
+      s->next += s->interval;
+    }
+  } else if (s->mode == SIM_LOG_SAMPLE_SUMMARY) {
+    // the last interval is cut short at the end of the simulation
+    sim_log_sampler_advance(s, sink, q, time);
+    sampler_emit_summary(s, sink, time);
+  }
+}
+
+void sim_log_windower_init(sim_log_windower_t* w, sim_time_t interval) {
+  memset(w, 0, sizeof(*w));
+  w->interval = interval;
+  w->next     = interval;
+  sim_accumulator_init(&w->turnaround);
+  sim_histogram_init(&w->turnaround_hist);
+}
+
+void sim_log_windower_advance(sim_log_windower_t* w,
+                              sim_log_sink_t*     sink,
+                              sim_log_queuelen_t* q,
+                              sim_time_t          time) {
+  if (time <= w->last) {
+    return;
+  }
+
+  // completions at a boundary belong to the window that starts there
+  while (w->next <= time) {
+    windower_accumulate(w, q, w->next - w->last);
+    windower_emit(w, sink, w->next);
+    w->last  = w->next;
+    w->next += w->interval;
+  }
+  windower_accumulate(w, q, time - w->last);
+  w->last = time;
+}
+
+void sim_log_windower_add_completion(sim_log_windower_t* w, double turnaround) {
+  w->sum.completions++;
+  if (turnaround >= 0) {
+    sim_accumulator_add(&w->turnaround, turnaround);
+    sim_histogram_add(&w->turnaround_hist, turnaround);
+  }
+}
+
+void sim_log_windower_finish(sim_log_windower_t* w,
+                             sim_log_sink_t*     sink,
+                             sim_log_queuelen_t* q,
+                             sim_time_t          time) {
+  // the last window is cut short at the end of the simulation
+  sim_log_windower_advance(w, sink, q, time);
+  windower_emit(w, sink, time);
+}
+
+void sim_log_print_queuelen(FILE* f, sim_log_queuelen_t* q) {
+  fprintf(f, "%lf %lu %lf %lf %lu %lf %lf\n",
+          sim_time_to_double(q->time),
+          q->realtime_jobs,
+          sim_time_to_double(q->realtime_total),
+          sim_time_to_double(q->realtime_remaining),
+          q->aperiodic_jobs,
+          sim_time_to_double(q->aperiodic_total),
+          sim_time_to_double(q->aperiodic_remaining));
+}
+
+// the first seven columns match the per-event queuelen log
+void sim_log_print_queuelen_summary(FILE* f, sim_log_queuelen_summary_t* q) {
+  fprintf(f, "%lf %lf %lf %lf %lf %lf %lf %lu %lu %lf\n",
+          sim_time_to_double(q->time),
+          q->realtime_jobs,
+          q->realtime_total,
+          q->realtime_remaining,
+          q->aperiodic_jobs,
+          q->aperiodic_total,
+          q->aperiodic_remaining,
+          q->realtime_max_jobs,
+          q->aperiodic_max_jobs,
+          sim_time_to_double(q->duration));
+}
+
+// throughput and utilization are derived, the rest is the record
+void sim_log_print_window(FILE* f, sim_log_window_t* w) {
+  double duration = sim_time_to_double(w->duration);
+
+  fprintf(f, "%lf %lu %lf %lf %lf %lu %lf %lf %lf\n",
+          sim_time_to_double(w->time),
+          w->completions,
+          w->completions / duration,
+          sim_time_to_double(w->busy) / duration,
+          w->jobs,
+          w->max_jobs,
+          w->turnaround,
+          w->turnaround_p99,
+          duration);
+}
+
+void sim_log_print_job(FILE*                 f,
+                       sim_log_kind_t        kind,
+                       sim_time_t            time,
+                       sim_log_record_type_t type,
+                       sim_job_t*            job) {
+  double t = sim_time_to_double(time);
+
+  switch (type) {
+    case SIM_LOG_JOB_ARRIVAL:
+      fprintf(f, "%lf JOB_ARRIVAL ", t);
+      break;
+
+    case SIM_LOG_TASK_ARRIVAL:
+      fprintf(f, "%lf TASK_ARRIVAL ", t);
+      break;
+
+    case SIM_LOG_TASK_ACCEPTED:
+      fprintf(f, "%lf %s ", t, " PERIODIC_TASK_ACCEPTED ");
+      break;
+
+    case SIM_LOG_TASK_REJECTED:
+      fprintf(f, "%lf %s ", t, " PERIODIC_TASK_REJECTED ");
+      break;
+
+    case SIM_LOG_JOB_ACCEPTED:
+    case SIM_LOG_JOB_REJECTED:
+      fprintf(f, kind == SIM_LOG_JOBS ? "%lf %s_JOB_%s # " : "%lf %s_JOB_%s ",
+              t, job_type_name(job), type == SIM_LOG_JOB_REJECTED ? "REJECTED" : "ACCEPTED");
+      break;
+
+    case SIM_LOG_JOB_DONE:
+      if (kind == SIM_LOG_JOBS) {
+        print_job_done(f, time, job);
+        return;
+      }
+      fprintf(f, "%lf DONE ", t);
+      break;
+
+    case SIM_LOG_TIMER:
+      fprintf(f, "%lf TIMER\n", t);
+      return;
+  }
+
+  sim_job_print(job, f);
+  fprintf(f, "\n");
+}
+
+void sim_log_print_queuelen_csv_header(FILE* f) {
+  fprintf(f, "time,realtime_jobs,realtime_total,realtime_remaining,"
+          "aperiodic_jobs,aperiodic_total,aperiodic_remaining\n");
+}
+
+void sim_log_print_queuelen_csv(FILE* f, sim_log_queuelen_t* q) {
+  fprintf(f, "%.9lf,%lu,%.9lf,%.9lf,%lu,%.9lf,%.9lf\n",
+          sim_time_to_double(q->time),
+          q->realtime_jobs,
+          sim_time_to_double(q->realtime_total),
+          sim_time_to_double(q->realtime_remaining),
+          q->aperiodic_jobs,
+          sim_time_to_double(q->aperiodic_total),
+          sim_time_to_double(q->aperiodic_remaining));
+}
+
+void sim_log_print_queuelen_summary_csv_header(FILE* f) {
+  fprintf(f, "time,mean_realtime_jobs,mean_realtime_total,mean_realtime_remaining,"
+          "mean_aperiodic_jobs,mean_aperiodic_total,mean_aperiodic_remaining,"
+          "max_realtime_jobs,max_aperiodic_jobs,duration\n");
+}
+
+void sim_log_print_queuelen_summary_csv(FILE* f, sim_log_queuelen_summary_t* q) {
+  fprintf(f, "%.9lf,%.9lf,%.9lf,%.9lf,%.9lf,%.9lf,%.9lf,%lu,%lu,%.9lf\n",
+          sim_time_to_double(q->time),
+          q->realtime_jobs,
+          q->realtime_total,
+          q->realtime_remaining,
+          q->aperiodic_jobs,
+          q->aperiodic_total,
+          q->aperiodic_remaining,
+          q->realtime_max_jobs,
+          q->aperiodic_max_jobs,
+          sim_time_to_double(q->duration));
+}
+
+void sim_log_print_window_csv_header(FILE* f) {
+  fprintf(f, "time,completions,throughput,utilization,mean_jobs,max_jobs,"
+          "mean_turnaround,p99_turnaround,duration\n");
+}
+
+void sim_log_print_window_csv(FILE* f, sim_log_window_t* w) {
+  double duration = sim_time_to_double(w->duration);
+
+  fprintf(f, "%.9lf,%lu,%.9lf,%.9lf,%.9lf,%lu,%.9lf,%.9lf,%.9lf\n",
+          sim_time_to_double(w->time),
+          w->completions,
+          w->completions / duration,
+          sim_time_to_double(w->busy) / duration,
+          w->jobs,
+          w->max_jobs,
+          w->turnaround,
+          w->turnaround_p99,
+          duration);
+}
+
+void sim_log_print_job_csv_header(FILE* f) {
+  fprintf(f, "time,record,job_id,job_type,arrival_time,size,remaining_size,"
+          "static_priority,dynamic_priority,deadline,period,numiters,first_arrival\n");
+}
+
+void sim_log_print_job_csv(FILE*                 f,
+                           sim_time_t            time,
+                           sim_log_record_type_t type,
+                           sim_job_t*            job) {
+  fprintf(f, "%.9lf,%s", sim_time_to_double(time), record_type_name(type));
+  if (type == SIM_LOG_TIMER) {
+    fprintf(f, ",,,,,,,,,,,\n");
+    return;
+  }
+  fprintf(f, ",%lu,%s,%.9lf,%.9lf,%.9lf,%lu,%lu,%.9lf,%.9lf,%lu,%d\n",
+          job->id,
+          job_type_name(job),
+          sim_time_to_double(job->arrival_time),
+          sim_time_to_double(job->size),
+          sim_time_to_double(job->remaining_size),
+          job->static_priority,
+          job->dynamic_priority,
+          sim_time_to_double(job->deadline),
+          sim_time_to_double(job->period),
+          job->numiters,
+          job->first_arrival);
+}
+
+int sim_log_read_header(FILE* f, sim_log_header_t* h) {
+  uint8_t b[SIM_LOG_HEADER_SIZE];
+
+  if (fread(b, 1, sizeof(b), f) != sizeof(b) ||
+      memcmp(b, SIM_LOG_MAGIC, sizeof(SIM_LOG_MAGIC))) {
+    ERROR("not a queuesim binary log\n");
+    return -1;
+  }
+
+  h->version       = get_u16(b + 8);
+  h->kind          = get_u16(b + 10);
+  h->ticks_per_sec = get_u64(b + 16);
+
+  if (h->version != SIM_LOG_VERSION ||
+      h->kind > SIM_LOG_WINDOW ||
+      h->ticks_per_sec != SIM_TIME_TICKS_PER_SEC) {
+    ERROR("unsupported binary log (version %u kind %u ticks %lu)\n",
+          h->version, h->kind, h->ticks_per_sec);
+    return -1;
+  }
+
+  return 0;
+}
+
+int sim_log_read_queuelen(FILE* f, sim_time_t* last_time, sim_log_queuelen_t* q) {
+  sim_time_t dt;
+
+  if (get_zigzag(f, &dt) ||
+      get_varint(f, &q->realtime_jobs) ||
+      get_zigzag(f, &q->realtime_total) ||
+      get_zigzag(f, &q->realtime_remaining) ||
+      get_varint(f, &q->aperiodic_jobs) ||
+      get_zigzag(f, &q->aperiodic_total) ||
+      get_zigzag(f, &q->aperiodic_remaining)) {
+    return -1;
+  }
+
+  q->time    = *last_time + dt;
+  *last_time = q->time;
+  return 0;
+}
+
+int sim_log_read_queuelen_summary(FILE* f, sim_time_t* last_time, sim_log_queuelen_summary_t* q) {
+  sim_time_t dt;
+
+  if (get_zigzag(f, &dt) ||
+      get_zigzag(f, &q->duration) ||
+      get_double(f, &q->realtime_jobs) ||
+      get_double(f, &q->realtime_total) ||
+      get_double(f, &q->realtime_remaining) ||
+      get_double(f, &q->aperiodic_jobs) ||
+      get_double(f, &q->aperiodic_total) ||
+      get_double(f, &q->aperiodic_remaining) ||
+      get_varint(f, &q->realtime_max_jobs) ||
+      get_varint(f, &q->aperiodic_max_jobs)) {
+    return -1;
+  }
+
+  q->time    = *last_time + dt;
+  *last_time = q->time;
+  return 0;
+}
+
+int sim_log_read_window(FILE* f, sim_time_t* last_time, sim_log_window_t* w) {
+  sim_time_t dt;
+
+  if (get_zigzag(f, &dt) ||
+      get_zigzag(f, &w->duration) ||
+      get_varint(f, &w->completions) ||
+      get_zigzag(f, &w->busy) ||
+      get_double(f, &w->jobs) ||
+      get_varint(f, &w->max_jobs) ||
+      get_double(f, &w->turnaround) ||
+      get_double(f, &w->turnaround_p99)) {
+    return -1;
+  }
+
+  w->time    = *last_time + dt;
+  *last_time = w->time;
+  return 0;
+}
+
+int sim_log_read_job(FILE*                  f,
+                     sim_time_t*            last_time,
+                     sim_time_t*            time,
+                     sim_log_record_type_t* type,
+                     sim_job_t*             job) {
+  sim_time_t dt;
+  int c;
+
+  if (get_zigzag(f, &dt) || (c = getc_unlocked(f)) == EOF) {
+    return -1;
+  }
+  *time      = *last_time + dt;
+  *type      = c;
+  *last_time = *time;
+
+  memset(job, 0, sizeof(*job));
+  if (*type == SIM_LOG_TIMER) {
+    return 0;
+  }
+
+  sim_time_t age;
+  if ((c = getc_unlocked(f)) == EOF ||
+      get_varint(f, &job->id) ||
+      get_zigzag(f, &age) ||
+      get_zigzag(f, &job->size) ||
+      get_zigzag(f, &job->remaining_size) ||
+      get_zigzag(f, &job->deadline) ||
+      get_zigzag(f, &job->period) ||
+      get_varint(f, &job->static_priority) ||
+      get_varint(f, &job->dynamic_priority) ||
+      get_varint(f, &job->numiters)) {
+    ERROR("truncated record\n");
+    return -1;
+  }
+  job->type          = c & 0xf;
+  job->first_arrival = c >> 4;
+  job->arrival_time  = *time - age;
+
+  return 0;
+}
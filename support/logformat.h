@@ -0,0 +1,312 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "job.h"
+#include "logwriter.h"
+#include "simtime.h"
+#include "stats.h"
+#include "trace.h"
+
+
+// The simulation produces three logs:
+//   queuelen - the state of both job queues at each event
+//   events   - every arrival, acceptance, completion, and timer interrupt
+//   jobs     - acceptance and completion (with turnaround) of each job
+//
+// Each log can be turned off, and instead of a record per event the
+// queuelen log can hold either a sample of the queues at every multiple
+// of a fixed simulated-time interval, or a time-weighted summary (mean
+// and maximum) of each interval
+//
+// A fourth log, off unless a window is given, is a time series of how
+// the scheduler is doing: for each fixed window of simulated time, the
+// completions, the busy time (jobs in the system), the time-weighted
+// number of jobs in the system, and the mean and 99th percentile
+// turnaround of the aperiodic jobs completed in it
+//
+// Each log can be written as text (the traditional format, which the
+// tools/ scripts and gnuplot read) or as a compact binary format
+//
+// A binary log is a fixed header followed by variable-length records
+// Every integer field of a record is a LEB128 varint (signed times are
+// zigzag encoded first), so small values take a single byte, and every
+// floating point field is 8 bytes, little-endian
+// Each record's time is stored as the number of ticks since the previous
+// record in the same log, and a job's arrival time relative to the
+// record's time, which keeps the common values small
+// queuesim-logdump converts binary logs back to text, or to CSV
+//
+// Varints were chosen over fixed-size records: they make the logs about
+// 3x smaller (a queuelen record averages 18 bytes on expexp0.9, against
+// 56 for the same fields at fixed size), and the logs are only ever read
+// front to back (by queuesim-logdump), so giving up seeking to record i
+// by offset costs nothing today.  The delta-encoded times already mean a
+// record cannot be decoded without those before it, fixed size or not.
+// A tool that needs random access should convert the log (to CSV) first
+
+typedef enum {
+  SIM_LOG_TEXT,
+  SIM_LOG_BINARY,
+} sim_log_format_t;
+
+typedef enum {
+  SIM_LOG_QUEUELEN,
+  SIM_LOG_EVENTS,
+  SIM_LOG_JOBS,
+  SIM_LOG_QUEUELEN_SUMMARY,
+  SIM_LOG_WINDOW,
+} sim_log_kind_t;
+
+typedef enum {
+  SIM_LOG_SAMPLE_EVERY_EVENT,
+  SIM_LOG_SAMPLE_INTERVAL,
+  SIM_LOG_SAMPLE_SUMMARY,
+} sim_log_queuelen_mode_t;
+
+// what happened to a job, for the events and jobs logs
+typedef enum {
+  SIM_LOG_JOB_ARRIVAL,
+  SIM_LOG_TASK_ARRIVAL,
+  SIM_LOG_TASK_ACCEPTED,
+  SIM_LOG_TASK_REJECTED,
+  SIM_LOG_JOB_ACCEPTED,
+  SIM_LOG_JOB_REJECTED,
+  SIM_LOG_JOB_DONE,
+  SIM_LOG_TIMER,
+} sim_log_record_type_t;
+
+// state of the job queues at one point in time
+typedef struct sim_log_queuelen {
+  sim_time_t time;
+  uint64_t realtime_jobs;
+  sim_time_t realtime_total;
+  sim_time_t realtime_remaining;
+  uint64_t aperiodic_jobs;
+  sim_time_t aperiodic_total;
+  sim_time_t aperiodic_remaining;
+} sim_log_queuelen_t;
+
+// time-weighted state of the job queues over one interval ending at time
+// the means of total and remaining time are in seconds
+typedef struct sim_log_queuelen_summary {
+  sim_time_t time;
+  sim_time_t duration;
+  double realtime_jobs;
+  double realtime_total;
+  double realtime_remaining;
+  double aperiodic_jobs;
+  double aperiodic_total;
+  double aperiodic_remaining;
+  uint64_t realtime_max_jobs;
+  uint64_t aperiodic_max_jobs;
+} sim_log_queuelen_summary_t;
+
+// one window of simulated time ending at time
+typedef struct sim_log_window {
+  sim_time_t time;
+  sim_time_t duration;
+  uint64_t completions;
+  sim_time_t busy;          // time with jobs in the system
+  double jobs;              // time-weighted mean jobs in the system
+  uint64_t max_jobs;
+  double turnaround;        // mean, in seconds (0 without completions)
+  double turnaround_p99;
+} sim_log_window_t;
+
+
+// binary log header
+#define SIM_LOG_MAGIC   "QSIMLOG"
+#define SIM_LOG_VERSION 1
+
+#define SIM_LOG_HEADER_SIZE 24
+
+// largest possible encoded record
+#define SIM_LOG_MAX_RECORD_SIZE 128
+
+typedef struct sim_log_header {
+  uint16_t version;
+  sim_log_kind_t kind;
+  uint64_t ticks_per_sec;
+} sim_log_header_t;
+
+
+// how the simulation writes its logs
+typedef struct sim_log_config {
+  sim_log_format_t format;
+
+  // which logs to write
+  bool queuelen;
+  bool events;
+  bool jobs;
+  bool trace; // the trace ring, dumped when the simulation finishes
+
+  // what the queuelen log records, interval is unused for every event
+  sim_log_queuelen_mode_t queuelen_mode;
+  sim_time_t queuelen_interval;
+
+  // length of the windows of the window log, 0 for no window log
+  sim_time_t window_interval;
+
+  // what happens to DEBUG() statements, and how many the ring keeps
+  sim_trace_mode_t trace_mode;
+  uint64_t trace_size;
+} sim_log_config_t;
+
+
+// one open log
+typedef struct sim_log_sink {
+  FILE* file;
+  sim_log_kind_t kind;
+  sim_log_format_t format;
+
+  // time of the last record, for delta encoding
+  sim_time_t last_time;
+} sim_log_sink_t;
+
+
+// turns queue states observed at each change of simulated time into
+// samples or interval summaries
+typedef struct sim_log_sampler {
+  sim_log_queuelen_mode_t mode;
+  sim_time_t interval;
+  sim_time_t next; // end of the current interval
+  sim_time_t last; // time up to which the queue state is accounted for
+
+  // time-weighted integrals over the current interval (summary mode)
+  sim_log_queuelen_summary_t sum;
+} sim_log_sampler_t;
+
+
+// turns queue states and job completions into the windows of a window log
+typedef struct sim_log_windower {
+  sim_time_t interval;
+  sim_time_t next; // end of the current window
+  sim_time_t last; // time up to which the queue state is accounted for
+
+  // the current window, with its integral of jobs rather than the mean
+  sim_log_window_t sum;
+  sim_accumulator_t turnaround;
+  sim_histogram_t turnaround_hist;
+} sim_log_windower_t;
+
+
+// default configuration: text logs, all written, queuelen every event,
+// and DEBUG() statements recorded into a trace ring
+void sim_log_config_init(sim_log_config_t* config);
+
+// parse a comma-separated list of logs to write
+//   (queuelen, events, jobs, trace, all, none)
+int sim_log_config_parse_logs(sim_log_config_t* config, char* spec);
+
+// parse a queuelen mode (event, sample:<seconds>, summary:<seconds>)
+int sim_log_config_parse_queuelen(sim_log_config_t* config, char* spec);
+
+// parse a window length in seconds
+int sim_log_config_parse_window(sim_log_config_t* config, char* spec);
+
+// parse a trace mode (ring, ring:<records>, stderr, off)
+int sim_log_config_parse_trace(sim_log_config_t* config, char* spec);
+
+
+// open a log through the writer, writing the header if it is binary
+// a sink that was never opened (file is NULL) ignores all writes
+int  sim_log_sink_open(sim_log_sink_t*   sink,
+                       sim_log_writer_t* writer,
+                       char*             path,
+                       sim_log_kind_t    kind,
+                       sim_log_format_t  format);
+void sim_log_sink_close(sim_log_sink_t* sink);
+
+// add records to a log in its format
+void sim_log_write_queuelen(sim_log_sink_t* sink, sim_log_queuelen_t* q);
+void sim_log_write_job(sim_log_sink_t*       sink,
+                       sim_time_t            time,
+                       sim_log_record_type_t type,
+                       sim_job_t*            job);
+
+void sim_log_write_queuelen_summary(sim_log_sink_t* sink, sim_log_queuelen_summary_t* q);
+void sim_log_write_window(sim_log_sink_t* sink, sim_log_window_t* w);
+
+// sampler for a queuelen log in sample or summary mode
+void sim_log_sampler_init(sim_log_sampler_t* s, sim_log_queuelen_mode_t mode, sim_time_t interval);
+
+// true if simulated time moving to time requires the queue state
+bool sim_log_sampler_due(sim_log_sampler_t* s, sim_time_t time);
+
+// simulated time is moving to time, and q is the queue state since the
+// previous call, write any samples or summaries that are now complete
+void sim_log_sampler_advance(sim_log_sampler_t*  s,
+                             sim_log_sink_t*     sink,
+                             sim_log_queuelen_t* q,
+                             sim_time_t          time);
+
+// the simulation ended at time with queue state q, write what remains
+void sim_log_sampler_finish(sim_log_sampler_t*  s,
+                            sim_log_sink_t*     sink,
+                            sim_log_queuelen_t* q,
+                            sim_time_t          time);
+
+// windower for a window log
+void sim_log_windower_init(sim_log_windower_t* w, sim_time_t interval);
+
+// simulated time is moving to time, and q is the queue state since the
+// previous call, write any windows that are now complete
+void sim_log_windower_advance(sim_log_windower_t* w,
+                              sim_log_sink_t*     sink,
+                              sim_log_queuelen_t* q,
+                              sim_time_t          time);
+
+// a job completed in the current window (turnaround < 0 if not aperiodic)
+void sim_log_windower_add_completion(sim_log_windower_t* w, double turnaround);
+
+// the simulation ended at time with queue state q, write the last
+// (possibly partial) window
+void sim_log_windower_finish(sim_log_windower_t* w,
+                             sim_log_sink_t*     sink,
+                             sim_log_queuelen_t* q,
+                             sim_time_t          time);
+
+// print records in the traditional text format
+void sim_log_print_queuelen(FILE* f, sim_log_queuelen_t* q);
+void sim_log_print_queuelen_summary(FILE* f, sim_log_queuelen_summary_t* q);
+void sim_log_print_window(FILE* f, sim_log_window_t* w);
+void sim_log_print_job(FILE*                 f,
+                       sim_log_kind_t        kind,
+                       sim_time_t            time,
+                       sim_log_record_type_t type,
+                       sim_job_t*            job);
+
+// print records as CSV, header first
+void sim_log_print_queuelen_csv_header(FILE* f);
+void sim_log_print_queuelen_csv(FILE* f, sim_log_queuelen_t* q);
+void sim_log_print_queuelen_summary_csv_header(FILE* f);
+void sim_log_print_queuelen_summary_csv(FILE* f, sim_log_queuelen_summary_t* q);
+void sim_log_print_window_csv_header(FILE* f);
+void sim_log_print_window_csv(FILE* f, sim_log_window_t* w);
+void sim_log_print_job_csv_header(FILE* f);
+void sim_log_print_job_csv(FILE*                 f,
+                           sim_time_t            time,
+                           sim_log_record_type_t type,
+                           sim_job_t*            job);
+
+// read back a binary log; last_time carries the delta decoding state
+// and must start at zero; the readers return 0 on success, -1 at the end
+int sim_log_read_header(FILE* f, sim_log_header_t* h);
+int sim_log_read_queuelen(FILE* f, sim_time_t* last_time, sim_log_queuelen_t* q);
+int sim_log_read_queuelen_summary(FILE* f, sim_time_t* last_time, sim_log_queuelen_summary_t* q);
+int sim_log_read_window(FILE* f, sim_time_t* last_time, sim_log_window_t* w);
+int sim_log_read_job(FILE*                  f,
+                     sim_time_t*            last_time,
+                     sim_time_t*            time,
+                     sim_log_record_type_t* type,
+                     sim_job_t*             job);
@@ -0,0 +1,231 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+// for fopencookie()
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "debug.h"
+#include "logwriter.h"
+
+
+// control debugging prints throughout this file
+#if DEBUG_LOG_WRITER
+#define DEBUG(fmt, args...) DEBUG_PRINT("logwriter: " fmt, ##args)
+#else
+#define DEBUG(fmt, args...)
+#endif
+#define ERROR(fmt, args...) ERROR_PRINT("logwriter: " fmt, ##args)
+#define INFO(fmt, args...)  INFO_PRINT("logwriter: " fmt, ##args)
+
+
+/* Internal helper functions */
+
+static void ring_init(sim_log_ring_t* r) {
+  atomic_init(&r->head, 0);
+  atomic_init(&r->tail, 0);
+  sem_init(&r->count, 0, 0);
+}
+
+static void ring_deinit(sim_log_ring_t* r) {
+  sem_destroy(&r->count);
+}
+
+// only ever called by the single producer of this ring
+// the ring has room for every chunk and the NULL shutdown marker at once,
+// so it never overflows
+static void ring_push(sim_log_ring_t* r, sim_log_chunk_t* c) {
+  uint64_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+  r->slots[tail & (SIM_LOG_RING_SLOTS - 1)] = c;
+  atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+  sem_post(&r->count);
+}
+
+// only ever called by the single consumer of this ring, waits if empty
+static sim_log_chunk_t* ring_pop(sim_log_ring_t* r) {
+  while (sem_wait(&r->count) && errno == EINTR) {
+  }
+  uint64_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  // pairs with the release in ring_push()
+  atomic_thread_fence(memory_order_acquire);
+  sim_log_chunk_t* c = r->slots[head & (SIM_LOG_RING_SLOTS - 1)];
+  atomic_store_explicit(&r->head, head + 1, memory_order_release);
+  return c;
+}
+
+// free the chunks and the rings, once the writer thread is stopped (or
+// was never started); chunks not yet allocated are NULL, which free() ignores
+static void writer_free(sim_log_writer_t* w) {
+  for (int i = 0; i < SIM_LOG_NUM_CHUNKS; i++) {
+    free(w->chunks[i].data);
+    w->chunks[i].data = NULL;
+  }
+  ring_deinit(&w->full);
+  ring_deinit(&w->empty);
+}
+
+static void* writer_thread(void* arg) {
+  sim_log_writer_t* w = (sim_log_writer_t*)arg;
+  sim_log_chunk_t* c;
+
+  // a NULL chunk means shut down
+  while ((c = ring_pop(&w->full))) {
+    size_t done = 0;
+    while (done < c->len) {
+      ssize_t n = write(c->fd, c->data + done, c->len - done);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        ERROR("failed to write log output: %s\n", strerror(errno));
+        break;
+      }
+      done += n;
+    }
+    c->len = 0;
+    ring_push(&w->empty, c);
+    atomic_fetch_add_explicit(&w->written, 1, memory_order_release);
+  }
+
+  return NULL;
+}
+
+// hand the stream's current chunk to the writer thread
+// chunks only ever return to the pool through the writer thread, which
+// keeps it the single producer of the empty ring
+static void stream_submit(sim_log_stream_t* s) {
+  if (s->cur) {
+    s->writer->submitted++;
+    ring_push(&s->writer->full, s->cur);
+    s->cur = NULL;
+  }
+}
+
+static ssize_t stream_write(void* cookie, const char* buf, size_t size) {
+  sim_log_stream_t* s = (sim_log_stream_t*)cookie;
+  size_t left = size;
+
+  while (left) {
+    if (!s->cur) {
+      s->cur     = ring_pop(&s->writer->empty);
+      s->cur->fd = s->fd;
+    }
+    size_t n = SIM_LOG_CHUNK_SIZE - s->cur->len;
+    if (n > left) {
+      n = left;
+    }
+    memcpy(s->cur->data + s->cur->len, buf, n);
+    s->cur->len += n;
+    buf         += n;
+    left        -= n;
+    if (s->cur->len == SIM_LOG_CHUNK_SIZE) {
+      stream_submit(s);
+    }
+  }
+
+  return size;
+}
+
+static int stream_close(void* cookie) {
+  sim_log_stream_t* s = (sim_log_stream_t*)cookie;
+
+  stream_submit(s);
+  s->file = NULL;
+
+  return 0;
+}
+
+
+/* Public functions */
+
+int sim_log_writer_init(sim_log_writer_t* w) {
+  memset(w, 0, sizeof(*w));
+
+  ring_init(&w->full);
+  ring_init(&w->empty);
+  atomic_init(&w->written, 0);
+
+  for (int i = 0; i < SIM_LOG_NUM_CHUNKS; i++) {
+    if (!(w->chunks[i].data = aligned_alloc(4096, SIM_LOG_CHUNK_SIZE))) {
+      ERROR("cannot allocate log chunk\n");
+      writer_free(w);
+      return -1;
+    }
+    ring_push(&w->empty, &w->chunks[i]);
+  }
+
+  // the thread is started last, so no failure leaves it running
+  if (pthread_create(&w->thread, NULL, writer_thread, w)) {
+    ERROR("cannot start log writer thread\n");
+    writer_free(w);
+    return -1;
+  }
+
+  return 0;
+}
+
+FILE* sim_log_writer_open(sim_log_writer_t* w, char* path) {
+  if (w->num_streams == SIM_LOG_MAX_STREAMS) {
+    ERROR("too many log streams\n");
+    return NULL;
+  }
+
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  sim_log_stream_t* s = &w->streams[w->num_streams];
+  s->writer = w;
+  s->fd     = fd;
+  s->cur    = NULL;
+
+  cookie_io_functions_t funcs = {
+    .read  = NULL,
+    .write = stream_write,
+    .seek  = NULL,
+    .close = stream_close,
+  };
+  if (!(s->file = fopencookie(s, "w", funcs))) {
+    close(fd);
+    return NULL;
+  }
+
+  w->num_streams++;
+  return s->file;
+}
+
+void sim_log_writer_sync(sim_log_writer_t* w) {
+  for (int i = 0; i < w->num_streams; i++) {
+    if (w->streams[i].file) {
+      fflush(w->streams[i].file);
+      stream_submit(&w->streams[i]);
+    }
+  }
+
+  while (atomic_load_explicit(&w->written, memory_order_acquire) != w->submitted) {
+    sched_yield();
+  }
+}
+
+void sim_log_writer_deinit(sim_log_writer_t* w) {
+  // the writer drains everything ahead of the shutdown marker
+  ring_push(&w->full, NULL);
+  pthread_join(w->thread, NULL);
+
+  for (int i = 0; i < w->num_streams; i++) {
+    close(w->streams[i].fd);
+  }
+  writer_free(w);
+}
@@ -0,0 +1,91 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+// The log writer turns ordinary FILE*s into asynchronous outputs
+// Whatever is written to such a FILE* is copied into large aligned
+// chunks, and full chunks are handed to a background thread through a
+// lock-free single-producer/single-consumer ring
+// The simulation thread therefore never calls write(2) itself, it only
+// waits if every chunk is in flight at once
+
+// size of each chunk of log output
+#define SIM_LOG_CHUNK_SIZE (1024 * 1024)
+
+// number of chunks shared by all streams (must be a power of 2)
+#define SIM_LOG_NUM_CHUNKS 16
+
+// slots in each ring: room for every chunk plus the shutdown marker
+#define SIM_LOG_RING_SLOTS (2 * SIM_LOG_NUM_CHUNKS)
+
+// maximum number of streams one writer can serve
+#define SIM_LOG_MAX_STREAMS 8
+
+
+typedef struct sim_log_chunk {
+  int fd;
+  size_t len;
+  char* data; // SIM_LOG_CHUNK_SIZE bytes, page aligned
+} sim_log_chunk_t;
+
+// single-producer/single-consumer ring of chunk pointers
+typedef struct sim_log_ring {
+  _Atomic uint64_t head; // next slot to pop, advanced by the consumer
+  _Atomic uint64_t tail; // next slot to push, advanced by the producer
+  sim_log_chunk_t* slots[SIM_LOG_RING_SLOTS];
+  sem_t count;           // number of chunks in the ring, for sleeping
+} sim_log_ring_t;
+
+typedef struct sim_log_stream {
+  struct sim_log_writer* writer;
+  FILE* file;           // NULL once closed
+  int fd;
+  sim_log_chunk_t* cur; // chunk being filled, NULL if none yet
+} sim_log_stream_t;
+
+// nothing in this struct may be modified by schedulers
+typedef struct sim_log_writer {
+  pthread_t thread;
+
+  // simulation thread -> writer thread
+  sim_log_ring_t full;
+  // writer thread -> simulation thread
+  sim_log_ring_t empty;
+
+  // used by sim_log_writer_sync() to wait for the writer to catch up
+  uint64_t submitted;
+  _Atomic uint64_t written;
+
+  sim_log_chunk_t chunks[SIM_LOG_NUM_CHUNKS];
+
+  int num_streams;
+  sim_log_stream_t streams[SIM_LOG_MAX_STREAMS];
+} sim_log_writer_t;
+
+
+// allocate chunks and start the writer thread
+int sim_log_writer_init(sim_log_writer_t* w);
+
+// open (truncate) a file whose output goes through the writer
+// close it with fclose() as usual, which hands off any remaining output
+FILE* sim_log_writer_open(sim_log_writer_t* w, char* path);
+
+// wait until everything written so far to open streams is in the files
+// use this before something else reads the logs during a run
+void sim_log_writer_sync(sim_log_writer_t* w);
+
+// write everything still outstanding, stop the thread, and close files
+// all streams must already have been closed with fclose()
+void sim_log_writer_deinit(sim_log_writer_t* w);
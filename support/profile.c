@@ -0,0 +1,200 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "debug.h"
+#include "event.h"
+#include "profile.h"
+
+
+// control debugging prints throughout this file
+#if DEBUG_PROFILE
+#define DEBUG(fmt, args...) DEBUG_PRINT("profile: " fmt, ##args)
+#else
+#define DEBUG(fmt, args...)
+#endif
+#define ERROR(fmt, args...) ERROR_PRINT("profile: " fmt, ##args)
+#define INFO(fmt, args...)  INFO_PRINT("profile: " fmt, ##args)
+
+
+// how long to calibrate the ticks against the clock
+#define CALIBRATE_NS (20 * 1000 * 1000ULL)
+// empty probes timed to estimate the overhead of one
+#define CALIBRATE_PROBES 1000
+
+
+_Static_assert(SIM_EVENT_DUMP_TRACE < SIM_PROFILE_NO_EVENT, "too many event types to profile");
+
+_Thread_local sim_profile_t* sim_profile_active = NULL;
+
+
+/* Private functions */
+
+static uint64_t clock_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static char* probe_name(sim_profile_probe_t probe) {
+  return probe == SIM_PROFILE_DISPATCH ? "dispatch" :
+         probe == SIM_PROFILE_EVENT_POST ? "event post" :
+         probe == SIM_PROFILE_EVENT_RESCHEDULE ? "event reschedule" :
+         probe == SIM_PROFILE_EVENT_GET ? "event get earliest" :
+         probe == SIM_PROFILE_SCHED_INIT ? "sched init" :
+         probe == SIM_PROFILE_SCHED_PERIODIC ? "sched periodic" :
+         probe == SIM_PROFILE_SCHED_SPORADIC ? "sched sporadic" :
+         probe == SIM_PROFILE_SCHED_APERIODIC ? "sched aperiodic" :
+         probe == SIM_PROFILE_SCHED_JOB_DONE ? "sched job done" :
+         probe == SIM_PROFILE_SCHED_TIMER ? "sched timer" :
+         probe == SIM_PROFILE_LOG_WRITE ? "log write" :
+         "unknown";
+}
+
+// ns per tick, by timing the ticks over a short stretch of the clock
+static double calibrate(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  uint64_t start_ns    = clock_ns();
+  uint64_t start_ticks = sim_profile_now();
+  uint64_t ns;
+  while ((ns = clock_ns() - start_ns) < CALIBRATE_NS) {
+  }
+  uint64_t ticks = sim_profile_now() - start_ticks;
+  return ticks ? (double)ns / ticks : 1;
+#else
+  return 1;
+#endif
+}
+
+// the smallest time between two back-to-back reads of the ticks
+static double probe_overhead(void) {
+  uint64_t best = UINT64_MAX;
+  for (int i = 0; i < CALIBRATE_PROBES; i++) {
+    uint64_t start = sim_profile_now();
+    uint64_t ticks = sim_profile_now() - start;
+    if (ticks < best) {
+      best = ticks;
+    }
+  }
+  return best;
+}
+
+// a value in the middle of a bucket
+static double bucket_value(int i) {
+  if (i < (1 << SIM_PROFILE_SUB_BITS)) {
+    return i;
+  }
+  int e        = (i >> SIM_PROFILE_SUB_BITS) + SIM_PROFILE_SUB_BITS - 1;
+  uint64_t sub = i & ((1 << SIM_PROFILE_SUB_BITS) - 1);
+  double low   = (double)(((1ULL << SIM_PROFILE_SUB_BITS) + sub) << (e - SIM_PROFILE_SUB_BITS));
+  return low + (double)(1ULL << (e - SIM_PROFILE_SUB_BITS)) / 2;
+}
+
+static double hist_quantile(sim_profile_hist_t* h, double q) {
+  uint64_t rank = (uint64_t)(q * (h->count - 1));
+  uint64_t seen = 0;
+  for (int i = 0; i < SIM_PROFILE_BUCKETS; i++) {
+    seen += h->buckets[i];
+    if (seen > rank) {
+      double v = bucket_value(i);
+      return v < h->max ? v : h->max;
+    }
+  }
+  return h->max;
+}
+
+
+/* Public functions */
+
+int sim_profile_init(sim_profile_t* p, bool enabled) {
+  memset(p, 0, sizeof(*p));
+  p->type        = SIM_PROFILE_NO_EVENT;
+  p->ns_per_tick = 1;
+
+  if (!enabled) {
+    return 0;
+  }
+  if (!PROFILE_HOT_PATH) {
+    ERROR("probes are compiled out (set PROFILE_HOT_PATH in debug.h)\n");
+    return -1;
+  }
+
+  if (!(p->hist = calloc(SIM_PROFILE_EVENT_TYPES, sizeof(*p->hist)))) {
+    ERROR("cannot allocate histograms\n");
+    return -1;
+  }
+  p->ns_per_tick = calibrate();
+  p->overhead    = probe_overhead();
+  DEBUG("%lf ns per tick, probe overhead %lf ticks\n", p->ns_per_tick, p->overhead);
+
+  sim_profile_active = p;
+  return 0;
+}
+
+void sim_profile_deinit(sim_profile_t* p) {
+  if (sim_profile_active == p) {
+    sim_profile_active = NULL;
+  }
+  free(p->hist);
+  p->hist = NULL;
+}
+
+void sim_profile_merge(sim_profile_t* dst, sim_profile_t* src) {
+  if (!dst->hist || !src->hist) {
+    return;
+  }
+  for (int t = 0; t < SIM_PROFILE_EVENT_TYPES; t++) {
+    for (int p = 0; p < SIM_PROFILE_NUM_PROBES; p++) {
+      sim_profile_hist_t* d = &dst->hist[t][p];
+      sim_profile_hist_t* s = &src->hist[t][p];
+      d->count += s->count;
+      d->sum   += s->sum;
+      if (s->max > d->max) {
+        d->max = s->max;
+      }
+      for (int i = 0; i < SIM_PROFILE_BUCKETS; i++) {
+        d->buckets[i] += s->buckets[i];
+      }
+    }
+  }
+}
+
+void sim_profile_print(sim_profile_t* p, FILE* f) {
+  if (!p->hist) {
+    return;
+  }
+
+  double ns = p->ns_per_tick;
+  fprintf(f, "hot path costs in ns (inclusive, %.3lf ns per tick, probe overhead %.0lf ns):\n",
+          ns, p->overhead * ns);
+  fprintf(f, "%-24s%-20s%12s%10s%10s%10s%12s%12s\n",
+          "event type", "operation", "count", "mean", "p50", "p99", "max", "total ms");
+
+  for (int t = 0; t < SIM_PROFILE_EVENT_TYPES; t++) {
+    char* type = t == SIM_PROFILE_NO_EVENT ? "(none)" : sim_event_type_name(t);
+    for (int i = 0; i < SIM_PROFILE_NUM_PROBES; i++) {
+      sim_profile_hist_t* h = &p->hist[t][i];
+      if (!h->count) {
+        continue;
+      }
+      fprintf(f, "%-24s%-20s%12lu%10.0lf%10.0lf%10.0lf%12.0lf%12.3lf\n",
+              type, probe_name(i), h->count,
+              (double)h->sum / h->count * ns,
+              hist_quantile(h, 0.5) * ns,
+              hist_quantile(h, 0.99) * ns,
+              h->max * ns,
+              h->sum * ns / 1e6);
+    }
+  }
+}
@@ -0,0 +1,155 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "debug.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+
+// Hot-path profile: what the simulator itself spends on each event
+// Probes around the event queue, the scheduler callbacks, and the log
+// writes read the time stamp counter before and after, and add the cost
+// to a histogram for the probe and the type of event being dispatched
+// (or, for taking an event off the queue, the type of that event)
+// Costs are inclusive: a scheduler callback includes the events it posts
+// and the logs it writes, and a dispatch includes everything
+//
+// With PROFILE_HOT_PATH 0 (in debug.h) the probes compile to nothing, and
+// otherwise a probe costs a predictable branch unless a profile is active
+
+typedef enum {
+  SIM_PROFILE_DISPATCH,         // all of sim_context_dispatch_event()
+  SIM_PROFILE_EVENT_POST,       // sim_event_queue_post()
+  SIM_PROFILE_EVENT_RESCHEDULE, // sim_event_queue_reschedule()
+  SIM_PROFILE_EVENT_GET,        // sim_event_queue_get_earliest_event()
+  SIM_PROFILE_SCHED_INIT,
+  SIM_PROFILE_SCHED_PERIODIC,
+  SIM_PROFILE_SCHED_SPORADIC,
+  SIM_PROFILE_SCHED_APERIODIC,
+  SIM_PROFILE_SCHED_JOB_DONE,
+  SIM_PROFILE_SCHED_TIMER,
+  SIM_PROFILE_LOG_WRITE,        // any sim_log_write_*() to an open log
+  SIM_PROFILE_NUM_PROBES,
+} sim_profile_probe_t;
+
+// costs are kept for up to this many event types (sim_event_type_t), and
+// those outside of any dispatch (loading the workload, initializing the
+// scheduler) go to the last one
+#define SIM_PROFILE_EVENT_TYPES 16
+#define SIM_PROFILE_NO_EVENT    (SIM_PROFILE_EVENT_TYPES - 1)
+
+// log-linear buckets of ticks: 4 per power of two, so quantiles are
+// within 25%, which is plenty for costs that vary by orders of magnitude
+#define SIM_PROFILE_SUB_BITS 2
+#define SIM_PROFILE_BUCKETS  (64 << SIM_PROFILE_SUB_BITS)
+
+typedef struct sim_profile_hist {
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+  uint64_t buckets[SIM_PROFILE_BUCKETS];
+} sim_profile_hist_t;
+
+typedef struct sim_profile {
+  int type;             // event type being dispatched
+  double ns_per_tick;
+  double overhead;      // ticks taken by an empty probe
+  // [event type][probe], allocated only when profiling
+  sim_profile_hist_t (*hist)[SIM_PROFILE_NUM_PROBES];
+} sim_profile_t;
+
+// profile that probes in this thread record into, NULL when not profiling
+// (set, like the trace, whenever a context starts work)
+extern _Thread_local sim_profile_t* sim_profile_active;
+
+
+// set up a profile, and when enabled allocate, calibrate, and activate it
+int  sim_profile_init(sim_profile_t* p, bool enabled);
+void sim_profile_deinit(sim_profile_t* p);
+
+// add the costs in src to dst
+void sim_profile_merge(sim_profile_t* dst, sim_profile_t* src);
+
+// print a table of the costs of each probe for each event type, in ns
+// (nothing if the profile is not enabled)
+void sim_profile_print(sim_profile_t* p, FILE* f);
+
+
+/* Probes */
+
+static inline uint64_t sim_profile_now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline int sim_profile_bucket(uint64_t ticks) {
+  if (ticks < (1 << SIM_PROFILE_SUB_BITS)) {
+    return ticks;
+  }
+  int e = 63 - __builtin_clzll(ticks);
+  return ((e - SIM_PROFILE_SUB_BITS + 1) << SIM_PROFILE_SUB_BITS) +
+         ((ticks >> (e - SIM_PROFILE_SUB_BITS)) & ((1 << SIM_PROFILE_SUB_BITS) - 1));
+}
+
+static inline void sim_profile_record(int type, sim_profile_probe_t probe, uint64_t start) {
+  uint64_t ticks        = sim_profile_now() - start;
+  sim_profile_hist_t* h = &sim_profile_active->hist[type][probe];
+
+  h->count++;
+  h->sum += ticks;
+  if (ticks > h->max) {
+    h->max = ticks;
+  }
+  h->buckets[sim_profile_bucket(ticks)]++;
+}
+
+#if PROFILE_HOT_PATH
+// start timing, into a new variable start
+#define SIM_PROFILE_BEGIN(start) \
+  uint64_t start = __builtin_expect(sim_profile_active != NULL, 0) ? sim_profile_now() : 0
+// stop timing, charging the current event type
+#define SIM_PROFILE_END(start, probe)                                      \
+  do {                                                                     \
+    if (__builtin_expect(sim_profile_active != NULL, 0)) {                 \
+      sim_profile_record(sim_profile_active->type, probe, start);          \
+    }                                                                      \
+  } while (0)
+// stop timing, charging the given event type
+#define SIM_PROFILE_END_TYPE(start, probe, type)                           \
+  do {                                                                     \
+    if (__builtin_expect(sim_profile_active != NULL, 0)) {                 \
+      sim_profile_record(type, probe, start);                              \
+    }                                                                      \
+  } while (0)
+// set the event type being dispatched
+#define SIM_PROFILE_SET_EVENT(t)                                           \
+  do {                                                                     \
+    if (__builtin_expect(sim_profile_active != NULL, 0)) {                 \
+      sim_profile_active->type = (t);                                      \
+    }                                                                      \
+  } while (0)
+#else
+#define SIM_PROFILE_BEGIN(start)
+#define SIM_PROFILE_END(start, probe)
+#define SIM_PROFILE_END_TYPE(start, probe, type)
+#define SIM_PROFILE_SET_EVENT(t)
+#endif
@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "list.h"
+#include "profile.h"
 #include "scheduler.h"
 
 
@@ -64,41 +65,62 @@ void sim_sched_list(FILE* o) {
   }
 }
 
+sim_sched_t* sim_sched_next(sim_sched_t* prev) {
+  struct list_head* next = prev ? prev->node.next : sched_list.next;
+  return next == &sched_list ? NULL : list_entry(next, sim_sched_t, node);
+}
+
 int sim_sched_init(sim_sched_t* sched, sim_context_t* context) {
-  return sched->ops->init(sched->state, context);
+  SIM_PROFILE_BEGIN(start);
+  int rc = sched->ops->init(sched->state, context);
+  SIM_PROFILE_END(start, SIM_PROFILE_SCHED_INIT);
+  return rc;
 }
 
 sim_sched_acceptance_t sim_sched_periodic_task_arrival(sim_sched_t*   sched,
                                                        sim_context_t* context,
-                                                       double         current_time,
+                                                       sim_time_t     current_time,
                                                        sim_job_t*     job) {
-  return sched->ops->periodic_job_arrival(sched->state, context, current_time, job);
+  SIM_PROFILE_BEGIN(start);
+  sim_sched_acceptance_t rc = sched->ops->periodic_job_arrival(sched->state, context, current_time, job);
+  SIM_PROFILE_END(start, SIM_PROFILE_SCHED_PERIODIC);
+  return rc;
 }
 
 sim_sched_acceptance_t sim_sched_sporadic_job_arrival(sim_sched_t*   sched,
                                                       sim_context_t* context,
-                                                      double         current_time,
+                                                      sim_time_t     current_time,
                                                       sim_job_t*     job) {
-  return sched->ops->sporadic_job_arrival(sched->state, context, current_time, job);
+  SIM_PROFILE_BEGIN(start);
+  sim_sched_acceptance_t rc = sched->ops->sporadic_job_arrival(sched->state, context, current_time, job);
+  SIM_PROFILE_END(start, SIM_PROFILE_SCHED_SPORADIC);
+  return rc;
 }
 
 sim_sched_acceptance_t sim_sched_aperiodic_job_arrival(sim_sched_t*   sched,
                                                        sim_context_t* context,
-                                                       double         current_time,
+                                                       sim_time_t     current_time,
                                                        sim_job_t*     job) {
-  return sched->ops->aperiodic_job_arrival(sched->state, context, current_time, job);
+  SIM_PROFILE_BEGIN(start);
+  sim_sched_acceptance_t rc = sched->ops->aperiodic_job_arrival(sched->state, context, current_time, job);
+  SIM_PROFILE_END(start, SIM_PROFILE_SCHED_APERIODIC);
+  return rc;
 }
 
 void sim_sched_job_done(sim_sched_t*   sched,
                         sim_context_t* context,
-                        double         current_time,
+                        sim_time_t     current_time,
                         sim_job_t*     job) {
+  SIM_PROFILE_BEGIN(start);
   sched->ops->job_done(sched->state, context, current_time, job);
+  SIM_PROFILE_END(start, SIM_PROFILE_SCHED_JOB_DONE);
 }
 
 void sim_sched_timer_interrupt(sim_sched_t*   sched,
                                sim_context_t* context,
-                               double         current_time) {
+                               sim_time_t     current_time) {
+  SIM_PROFILE_BEGIN(start);
   sched->ops->timer_interrupt(sched->state, context, current_time);
+  SIM_PROFILE_END(start, SIM_PROFILE_SCHED_TIMER);
 }
 
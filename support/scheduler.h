@@ -12,6 +12,7 @@
 
 #include "job.h"
 #include "list.h"
+#include "simtime.h"
 
 
 // forward declarations to avoid header dependency
@@ -33,25 +34,25 @@ typedef struct sim_sched_ops {
 
   sim_sched_acceptance_t (* periodic_job_arrival)(void*          state,
                                                   sim_context_t* context,
-                                                  double         current_time,
+                                                  sim_time_t     current_time,
                                                   sim_job_t*     job);
   sim_sched_acceptance_t (* sporadic_job_arrival)(void*          state,
                                                   sim_context_t* context,
-                                                  double         current_time,
+                                                  sim_time_t     current_time,
                                                   sim_job_t*     job);
   sim_sched_acceptance_t (* aperiodic_job_arrival)(void*          state,
                                                    sim_context_t* context,
-                                                   double         current_time,
+                                                   sim_time_t     current_time,
                                                    sim_job_t*     job);
 
   void (* job_done)(void*          state,
                     sim_context_t* context,
-                    double         current_time,
+                    sim_time_t     current_time,
                     sim_job_t*     job);
 
   void (* timer_interrupt)(void*          state,
                            sim_context_t* context,
-                           double         current_time);
+                           sim_time_t     current_time);
 } sim_sched_ops_t;
 
 // maximum string length of scheduler names
@@ -82,6 +83,10 @@ sim_sched_t* sim_sched_find(char* name);
 // print list of schedulers
 void sim_sched_list(FILE* o);
 
+// walk the registered schedulers: the first with NULL, then each in turn,
+// NULL after the last
+sim_sched_t* sim_sched_next(sim_sched_t* prev);
+
 
 /* Functions that forward to the specific scheduler instance */
 
@@ -89,25 +94,25 @@ int sim_sched_init(sim_sched_t* sched, sim_context_t* context);
 
 sim_sched_acceptance_t sim_sched_periodic_task_arrival(sim_sched_t*   sched,
                                                        sim_context_t* context,
-                                                       double         current_time,
+                                                       sim_time_t     current_time,
                                                        sim_job_t*     job);
 
 sim_sched_acceptance_t sim_sched_sporadic_job_arrival(sim_sched_t*   sched,
                                                       sim_context_t* context,
-                                                      double         current_time,
+                                                      sim_time_t     current_time,
                                                       sim_job_t*     job);
 
 sim_sched_acceptance_t sim_sched_aperiodic_job_arrival(sim_sched_t*   sched,
                                                        sim_context_t* context,
-                                                       double         current_time,
+                                                       sim_time_t     current_time,
                                                        sim_job_t*     job);
 
 void sim_sched_job_done(sim_sched_t*   sched,
                         sim_context_t* context,
-                        double         current_time,
+                        sim_time_t     current_time,
                         sim_job_t*     job);
 
 void sim_sched_timer_interrupt(sim_sched_t*   sched,
                                sim_context_t* context,
-                               double         current_time);
+                               sim_time_t     current_time);
 
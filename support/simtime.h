@@ -0,0 +1,32 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+
+// Simulated time is kept as a signed 64-bit count of nanosecond ticks
+// Timestamps, job sizes, deadlines, and the quantum all use this type,
+// so ordering and arithmetic in the simulation are exact
+// Workload files and statistics remain in (floating point) seconds,
+// and are converted at those boundaries with the functions below
+typedef int64_t sim_time_t;
+
+#define SIM_TIME_TICKS_PER_SEC 1000000000LL
+
+
+// convert seconds to ticks, rounding to the nearest tick
+static inline sim_time_t sim_time_from_double(double seconds) {
+  return (sim_time_t)llround(seconds * SIM_TIME_TICKS_PER_SEC);
+}
+
+// convert ticks to seconds
+static inline double sim_time_to_double(sim_time_t t) {
+  return (double)t / SIM_TIME_TICKS_PER_SEC;
+}
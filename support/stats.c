@@ -0,0 +1,444 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+#include "stats.h"
+
+
+// control debugging prints throughout this file
+#if DEBUG_STATS
+#define DEBUG(fmt, args...) DEBUG_PRINT("stats: " fmt, ##args)
+#else
+#define DEBUG(fmt, args...)
+#endif
+#define ERROR(fmt, args...) ERROR_PRINT("stats: " fmt, ##args)
+#define INFO(fmt, args...)  INFO_PRINT("stats: " fmt, ##args)
+
+
+/* Accumulators */
+
+void sim_accumulator_init(sim_accumulator_t* a) {
+  memset(a, 0, sizeof(*a));
+}
+
+// sum += v, keeping the rounding error (Neumaier's variant of Kahan)
+static inline void compensated_add(double* sum, double* error, double v) {
+  double t = *sum + v;
+  if (fabs(*sum) >= fabs(v)) {
+    *error += (*sum - t) + v;
+  } else {
+    *error += (v - t) + *sum;
+  }
+  *sum = t;
+}
+
+void sim_accumulator_add(sim_accumulator_t* a, double v) {
+  a->count++;
+  compensated_add(&a->sum, &a->sum_error, v);
+
+  double delta = v - a->mean;
+  a->mean += delta / a->count;
+  a->m2   += delta * (v - a->mean);
+}
+
+void sim_accumulator_merge(sim_accumulator_t* dst, sim_accumulator_t* src) {
+  if (!src->count) {
+    return;
+  }
+  if (!dst->count) {
+    *dst = *src;
+    return;
+  }
+
+  double n_a   = dst->count;
+  double n_b   = src->count;
+  double n     = n_a + n_b;
+  double delta = src->mean - dst->mean;
+
+  dst->m2    += src->m2 + delta * delta * n_a * n_b / n;
+  dst->mean  += delta * n_b / n;
+  dst->count += src->count;
+  compensated_add(&dst->sum, &dst->sum_error, src->sum);
+  dst->sum_error += src->sum_error;
+}
+
+double sim_accumulator_sum(sim_accumulator_t* a) {
+  return a->sum + a->sum_error;
+}
+
+double sim_accumulator_mean(sim_accumulator_t* a) {
+  // the compensated sum gives the most accurate mean
+  return a->count ? sim_accumulator_sum(a) / a->count : 0;
+}
+
+double sim_accumulator_variance(sim_accumulator_t* a) {
+  return a->count < 2 ? 0 : a->m2 / (a->count - 1);
+}
+
+double sim_accumulator_stddev(sim_accumulator_t* a) {
+  return sqrt(sim_accumulator_variance(a));
+}
+
+
+/* Histograms */
+
+#define SUB_BUCKETS (1 << SIM_HISTOGRAM_SUB_BITS)
+
+void sim_histogram_init(sim_histogram_t* h) {
+  memset(h, 0, sizeof(*h));
+}
+
+void sim_histogram_add(sim_histogram_t* h, double v) {
+  if (h->count == 0 || v < h->min) {
+    h->min = v;
+  }
+  if (h->count == 0 || v > h->max) {
+    h->max = v;
+  }
+  h->count++;
+
+  // the exponent and the top bits of the mantissa pick the bucket
+  uint64_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+  int64_t exponent = (int64_t)((bits >> 52) & 0x7ff) - 1023;
+
+  if (v <= 0 || exponent < SIM_HISTOGRAM_MIN_EXP) {
+    h->zero++;
+    return;
+  }
+
+  int64_t i = ((exponent - SIM_HISTOGRAM_MIN_EXP) << SIM_HISTOGRAM_SUB_BITS) |
+              ((bits >> (52 - SIM_HISTOGRAM_SUB_BITS)) & (SUB_BUCKETS - 1));
+  if (i >= SIM_HISTOGRAM_BUCKETS) {
+    i = SIM_HISTOGRAM_BUCKETS - 1;
+  }
+  h->buckets[i]++;
+}
+
+void sim_histogram_merge(sim_histogram_t* dst, sim_histogram_t* src) {
+  if (!src->count) {
+    return;
+  }
+  if (!dst->count || src->min < dst->min) {
+    dst->min = src->min;
+  }
+  if (!dst->count || src->max > dst->max) {
+    dst->max = src->max;
+  }
+  dst->count += src->count;
+  dst->zero  += src->zero;
+  for (int i = 0; i < SIM_HISTOGRAM_BUCKETS; i++) {
+    dst->buckets[i] += src->buckets[i];
+  }
+}
+
+double sim_histogram_quantile(sim_histogram_t* h, double q) {
+  if (!h->count) {
+    return 0;
+  }
+
+  // nearest rank
+  uint64_t rank = (uint64_t)ceil(q * h->count);
+  if (rank < 1) {
+    rank = 1;
+  }
+
+  if (rank >= h->count) {
+    return h->max;
+  }
+
+  uint64_t seen = h->zero;
+  if (rank == 1 || seen >= rank) {
+    return h->min;
+  }
+
+  for (int i = 0; i < SIM_HISTOGRAM_BUCKETS; i++) {
+    seen += h->buckets[i];
+    if (seen >= rank) {
+      // middle of the bucket, but never outside what was seen
+      int exponent = (i >> SIM_HISTOGRAM_SUB_BITS) + SIM_HISTOGRAM_MIN_EXP;
+      double sub   = (i & (SUB_BUCKETS - 1)) + 0.5;
+      double v     = ldexp(1.0 + sub / SUB_BUCKETS, exponent);
+      return fmin(fmax(v, h->min), h->max);
+    }
+  }
+
+  return h->max;
+}
+
+
+/* Classes */
+
+void sim_class_stats_init(sim_class_stats_t* c) {
+  sim_accumulator_init(&c->turnaround);
+  sim_accumulator_init(&c->slowdown);
+}
+
+void sim_class_stats_add(sim_class_stats_t* c, double turnaround, double slowdown) {
+  sim_accumulator_add(&c->turnaround, turnaround);
+  sim_accumulator_add(&c->slowdown, slowdown);
+}
+
+void sim_class_stats_merge(sim_class_stats_t* dst, sim_class_stats_t* src) {
+  sim_accumulator_merge(&dst->turnaround, &src->turnaround);
+  sim_accumulator_merge(&dst->slowdown, &src->slowdown);
+}
+
+// class k > 0 holds 2^(k-1) to 2^k - 1
+int sim_stats_priority_class(uint64_t priority) {
+  int cls = priority ? 64 - __builtin_clzll(priority) : 0;
+  return cls < SIM_STATS_PRIORITY_CLASSES ? cls : SIM_STATS_PRIORITY_CLASSES - 1;
+}
+
+// class k > 0 holds 2^(MIN_EXP + k - 1) up to 2^(MIN_EXP + k)
+int sim_stats_size_class(double size) {
+  int exponent;
+  frexp(size, &exponent);   // size is in [2^(exponent-1), 2^exponent)
+
+  int cls = size > 0 ? exponent - SIM_STATS_SIZE_MIN_EXP : 0;
+  if (cls < 0) {
+    return 0;
+  }
+  return cls < SIM_STATS_SIZE_CLASSES ? cls : SIM_STATS_SIZE_CLASSES - 1;
+}
+
+void sim_stats_priority_class_name(int cls, char* buf, int len) {
+  uint64_t low  = cls ? 1ULL << (cls - 1) : 0;
+  uint64_t high = cls ? (1ULL << cls) - 1 : 0;
+
+  if (cls == SIM_STATS_PRIORITY_CLASSES - 1) {
+    snprintf(buf, len, ">=%lu", low);
+  } else if (low == high) {
+    snprintf(buf, len, "%lu", low);
+  } else {
+    snprintf(buf, len, "%lu-%lu", low, high);
+  }
+}
+
+void sim_stats_size_class_name(int cls, char* buf, int len) {
+  double low  = ldexp(1, SIM_STATS_SIZE_MIN_EXP + cls - 1);
+  double high = ldexp(1, SIM_STATS_SIZE_MIN_EXP + cls);
+
+  if (cls == 0) {
+    snprintf(buf, len, "<%.3g", high);
+  } else if (cls == SIM_STATS_SIZE_CLASSES - 1) {
+    snprintf(buf, len, ">=%.3g", low);
+  } else {
+    snprintf(buf, len, "%.3g-%.3g", low, high);
+  }
+}
+
+
+/* Batch means */
+
+void sim_batch_means_init(sim_batch_means_t* b) {
+  memset(b, 0, sizeof(*b));
+  b->batch_size = 1;
+}
+
+// merge adjacent pairs of batches, doubling the batch size
+// an odd batch left over goes back into the partial batch, which is only
+// ever the case when merging runs
+static void batch_means_double(sim_batch_means_t* b) {
+  int n = b->num_batches;
+  for (int i = 0; i < n / 2; i++) {
+    b->means[i] = (b->means[2 * i] + b->means[2 * i + 1]) / 2;
+  }
+  if (n % 2) {
+    b->batch_sum += b->means[n - 1] * b->batch_size;
+    b->in_batch  += b->batch_size;
+  }
+  b->num_batches = n / 2;
+  b->batch_size *= 2;
+  DEBUG("batch size now %lu\n", b->batch_size);
+}
+
+// add count observations that sum to sum, returning 1 if they completed a
+// batch
+// The same as adding them one at a time if they fit in the partial batch,
+// otherwise the batch takes all of them (which only merging runs does)
+static int batch_means_add_sum(sim_batch_means_t* b, double sum, uint64_t count) {
+  b->batch_sum += sum;
+  b->in_batch  += count;
+  if (b->in_batch < b->batch_size) {
+    return 0;
+  }
+
+  b->means[b->num_batches++] = b->batch_sum / b->in_batch;
+  b->batch_sum = 0;
+  b->in_batch  = 0;
+
+  if (b->num_batches == SIM_BATCH_MEANS_MAX) {
+    batch_means_double(b);
+  }
+
+  return 1;
+}
+
+int sim_batch_means_add(sim_batch_means_t* b, double v) {
+  return batch_means_add_sum(b, v, 1);
+}
+
+void sim_batch_means_merge(sim_batch_means_t* dst, sim_batch_means_t* src) {
+  sim_batch_means_t s = *src;
+
+  // bring both to the larger batch size, then add src's batches as runs
+  // of observations after dst's
+  while (dst->batch_size < s.batch_size) {
+    batch_means_double(dst);
+  }
+  while (s.batch_size < dst->batch_size) {
+    batch_means_double(&s);
+  }
+  for (int i = 0; i < s.num_batches; i++) {
+    batch_means_add_sum(dst, s.means[i] * s.batch_size, s.batch_size);
+  }
+  if (s.in_batch) {
+    batch_means_add_sum(dst, s.batch_sum, s.in_batch);
+  }
+}
+
+double sim_batch_means_mean(sim_batch_means_t* b) {
+  double sum = 0;
+  for (int i = 0; i < b->num_batches; i++) {
+    sum += b->means[i];
+  }
+  return b->num_batches ? sum / b->num_batches : 0;
+}
+
+double sim_batch_means_halfwidth(sim_batch_means_t* b) {
+  int n = b->num_batches;
+  if (n < 2) {
+    return 0;
+  }
+
+  double mean = sim_batch_means_mean(b);
+  double ss   = 0;
+  for (int i = 0; i < n; i++) {
+    ss += (b->means[i] - mean) * (b->means[i] - mean);
+  }
+
+  return sim_stats_t975(n - 1) * sqrt(ss / (n - 1) / n);
+}
+
+double sim_stats_t975(int df) {
+  static const double table[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080,  2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042,
+  };
+
+  if (df < 1) {
+    return INFINITY;
+  }
+  if (df <= 30) {
+    return table[df - 1];
+  }
+
+  // Cornish-Fisher expansion around the normal quantile
+  double z = 1.959964;
+  double z3 = z * z * z, z5 = z3 * z * z;
+  return z + (z3 + z) / (4.0 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96.0 * df * df);
+}
+
+
+/* Warm-up detection */
+
+void sim_mser_init(sim_mser_t* m) {
+  memset(m, 0, sizeof(*m));
+  m->batch_size = SIM_MSER_BATCH;
+  m->next_check = SIM_MSER_MIN;
+}
+
+int64_t sim_mser_add(sim_mser_t* m, double v) {
+  m->batch_sum += v;
+  if (++m->in_batch < m->batch_size) {
+    return -1;
+  }
+
+  int n = m->num_batches++;
+  m->means[n]  = m->batch_sum / m->batch_size;
+  m->ends[n]   = (n ? m->ends[n - 1] : 0) + m->batch_size;
+  m->batch_sum = 0;
+  m->in_batch  = 0;
+
+  if (m->num_batches < m->next_check) {
+    return -1;
+  }
+
+  int d = sim_mser_truncation(m->means, m->num_batches);
+  DEBUG("mser: %d batches of %lu, truncate %d\n", m->num_batches, m->batch_size, d);
+  if (d <= m->num_batches / 2) {
+    return d ? m->ends[d - 1] : 0;
+  }
+
+  if (m->num_batches == SIM_MSER_MAX) {
+    for (int i = 0; i < SIM_MSER_MAX / 2; i++) {
+      m->means[i] = (m->means[2 * i] + m->means[2 * i + 1]) / 2;
+      m->ends[i]  = m->ends[2 * i + 1];
+    }
+    m->num_batches = SIM_MSER_MAX / 2;
+    m->batch_size *= 2;
+  }
+  m->next_check = m->num_batches + SIM_MSER_STEP;
+  return -1;
+}
+
+int sim_mser_truncation(double* means, int n) {
+  // shift by the overall mean so the sums of squares do not cancel
+  double shift = 0;
+  for (int i = 0; i < n; i++) {
+    shift += means[i];
+  }
+  shift /= n;
+
+  // suffix sums from the end, so each truncation point is O(1)
+  double s1 = 0, s2 = 0, best = INFINITY;
+  int best_d = 0;
+  for (int d = n - 1; d >= 0; d--) {
+    double z = means[d] - shift;
+    s1 += z;
+    s2 += z * z;
+    if (d > n - 2) {
+      continue;
+    }
+    double k    = n - d;
+    double mser = (s2 - s1 * s1 / k) / (k * k);
+    if (mser <= best) {
+      best   = mser;
+      best_d = d;
+    }
+  }
+
+  return best_d;
+}
+
+
+/* Quantiles */
+
+int sim_stats_parse_quantiles(const char* s, double* quantiles, int max) {
+  int n = 0;
+  char* end;
+
+  while (*s) {
+    double p = strtod(s, &end);
+    if (end == s || (*end && *end != ',') || p < 0 || p > 100 || n == max) {
+      return -1;
+    }
+    quantiles[n++] = p / 100;
+    s = *end ? end + 1 : end;
+  }
+
+  return n;
+}
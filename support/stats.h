@@ -0,0 +1,175 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <stdint.h>
+
+
+// Running count, sum, mean and variance of a series of values
+// The sum is Kahan (Neumaier) compensated and the mean and variance are
+// kept with Welford's update, so neither loses precision over billions of
+// values the way sum and sum of squares do
+// Two accumulators (from other replications or threads) can be merged,
+// using Chan et al's formula for the combined variance
+typedef struct sim_accumulator {
+  uint64_t count;
+  double sum;
+  double sum_error;     // compensation for the low bits lost from sum
+  double mean;
+  double m2;            // sum of squared differences from the mean
+} sim_accumulator_t;
+
+// A histogram of positive values with log-linear buckets, in the style of
+// HdrHistogram: each power of two is split into 2^SIM_HISTOGRAM_SUB_BITS
+// equal buckets, so any quantile is reported to within 0.4% of the value
+// Memory is fixed and adding a value is a few bit operations on its
+// floating point representation
+// Values from 2^SIM_HISTOGRAM_MIN_EXP (about a tick) up to
+// 2^SIM_HISTOGRAM_MAX_EXP are resolved, smaller ones count as zero and
+// larger ones go in the last bucket (the exact minimum and maximum are
+// kept too)
+
+#define SIM_HISTOGRAM_SUB_BITS 7
+#define SIM_HISTOGRAM_MIN_EXP  (-30)
+#define SIM_HISTOGRAM_MAX_EXP  40
+#define SIM_HISTOGRAM_BUCKETS  ((SIM_HISTOGRAM_MAX_EXP - SIM_HISTOGRAM_MIN_EXP) << SIM_HISTOGRAM_SUB_BITS)
+
+typedef struct sim_histogram {
+  uint64_t count;
+  uint64_t zero;        // values below the smallest bucket
+  double min;
+  double max;
+  uint64_t buckets[SIM_HISTOGRAM_BUCKETS];
+} sim_histogram_t;
+
+// Turnaround and slowdown of one class of jobs
+// Jobs are classed by static priority, in ranges that double in width
+// (0, 1, 2-3, 4-7, ...), and by size, in buckets of a power of two
+// seconds from 2^SIM_STATS_SIZE_MIN_EXP to 2^SIM_STATS_SIZE_MAX_EXP, with
+// a class below and above those; finding the class is a bit operation
+typedef struct sim_class_stats {
+  sim_accumulator_t turnaround;
+  sim_accumulator_t slowdown;
+} sim_class_stats_t;
+
+#define SIM_STATS_PRIORITY_CLASSES 12
+#define SIM_STATS_SIZE_MIN_EXP     (-10)
+#define SIM_STATS_SIZE_MAX_EXP     10
+#define SIM_STATS_SIZE_CLASSES     (SIM_STATS_SIZE_MAX_EXP - SIM_STATS_SIZE_MIN_EXP + 2)
+
+#define SIM_BATCH_MEANS_MAX 64
+
+// Batch means of a series of (correlated) observations, for a confidence
+// interval on their mean
+// Observations are grouped into batches of batch_size and the mean of
+// each batch is kept; when SIM_BATCH_MEANS_MAX batches are full, adjacent
+// pairs are merged and the batch size doubles, so memory is fixed and the
+// batches grow long enough to be nearly independent as the run goes on
+// The interval is the Student t interval over the batch means
+typedef struct sim_batch_means {
+  uint64_t batch_size;
+  uint64_t in_batch;    // observations in the current, partial batch
+  double batch_sum;
+  int num_batches;
+  double means[SIM_BATCH_MEANS_MAX];
+} sim_batch_means_t;
+
+// MSER-5 warm-up detection over a series of observations
+// Observations are averaged in batches of SIM_MSER_BATCH, and the
+// truncation point is the number of leading batches whose removal
+// minimizes the squared standard error of the mean of the rest
+// The rule is applied as the series reaches SIM_MSER_MIN batches and then
+// every SIM_MSER_STEP batches, so the warm-up is found soon after enough
+// data follows it; it is over once the truncation point falls in the
+// first half of the series (otherwise there is too little data after it
+// to trust)  Past SIM_MSER_MAX batches, adjacent pairs are merged, so
+// memory is fixed
+#define SIM_MSER_BATCH 5
+#define SIM_MSER_MIN   64
+#define SIM_MSER_STEP  16
+#define SIM_MSER_MAX   1024
+
+typedef struct sim_mser {
+  uint64_t batch_size;
+  uint64_t in_batch;
+  double batch_sum;
+  int num_batches;
+  int next_check;
+  double means[SIM_MSER_MAX];
+  uint64_t ends[SIM_MSER_MAX];  // observations up to the end of each batch
+} sim_mser_t;
+
+// quantiles printed with the statistics, in percent
+#define SIM_STATS_MAX_QUANTILES     8
+#define SIM_STATS_DEFAULT_QUANTILES "50,90,99,99.9"
+
+
+void sim_accumulator_init(sim_accumulator_t* a);
+void sim_accumulator_add(sim_accumulator_t* a, double v);
+
+// add every value in src to dst
+void sim_accumulator_merge(sim_accumulator_t* dst, sim_accumulator_t* src);
+
+// 0 when there are no values (no stddev with fewer than 2)
+double sim_accumulator_sum(sim_accumulator_t* a);
+double sim_accumulator_mean(sim_accumulator_t* a);
+double sim_accumulator_variance(sim_accumulator_t* a);
+double sim_accumulator_stddev(sim_accumulator_t* a);
+
+
+void sim_histogram_init(sim_histogram_t* h);
+void sim_histogram_add(sim_histogram_t* h, double v);
+
+// add every value in src to dst
+void sim_histogram_merge(sim_histogram_t* dst, sim_histogram_t* src);
+
+// value at quantile q (0 to 1), 0 when empty
+double sim_histogram_quantile(sim_histogram_t* h, double q);
+
+
+void sim_class_stats_init(sim_class_stats_t* c);
+void sim_class_stats_add(sim_class_stats_t* c, double turnaround, double slowdown);
+void sim_class_stats_merge(sim_class_stats_t* dst, sim_class_stats_t* src);
+
+// class of a job with a static priority, or a size in seconds
+int sim_stats_priority_class(uint64_t priority);
+int sim_stats_size_class(double size);
+
+// describe the values in a class ("4-7", "0.25-0.5") for printing
+void sim_stats_priority_class_name(int cls, char* buf, int len);
+void sim_stats_size_class_name(int cls, char* buf, int len);
+
+
+void sim_batch_means_init(sim_batch_means_t* b);
+// add an observation, returning 1 if it completed a batch
+int  sim_batch_means_add(sim_batch_means_t* b, double v);
+
+// mean of the complete batches, and the half-width of the 95% confidence
+// interval around it (0 with fewer than 2 batches)
+double sim_batch_means_mean(sim_batch_means_t* b);
+double sim_batch_means_halfwidth(sim_batch_means_t* b);
+
+// add src's observations to dst, as if they had followed dst's
+// exactly the batches of one pass over both when dst ends on a batch
+// boundary at the merged batch size, as runs of equal length do
+void sim_batch_means_merge(sim_batch_means_t* dst, sim_batch_means_t* src);
+
+void sim_mser_init(sim_mser_t* m);
+// add an observation, returning the number of leading observations that
+// are warm-up once it has been detected, and -1 until then
+int64_t sim_mser_add(sim_mser_t* m, double v);
+
+// the MSER truncation point of a series of n batch means, in batches
+int sim_mser_truncation(double* means, int n);
+
+// 97.5th percentile of Student's t distribution with df degrees of freedom
+double sim_stats_t975(int df);
+
+// parse a comma-separated list of percentiles ("50,99,99.9") into at most
+// max quantiles (0 to 1), returning how many or -1 if malformed
+int sim_stats_parse_quantiles(const char* s, double* quantiles, int max);
@@ -0,0 +1,148 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+
+// no DEBUG/ERROR macros here: they record into the trace themselves
+
+
+_Thread_local sim_trace_t* sim_trace_active = NULL;
+
+
+/* Public functions */
+
+int sim_trace_init(sim_trace_t* t, sim_trace_mode_t mode, uint64_t size, const sim_time_t* now) {
+  memset(t, 0, sizeof(*t));
+  t->mode = mode;
+  t->now  = now;
+
+  if (mode == SIM_TRACE_RING) {
+    uint64_t n = 1;
+    while (n < size) {
+      n <<= 1;
+    }
+    if (!(t->records = calloc(n, sizeof(sim_trace_record_t)))) {
+      fprintf(stderr, "trace: cannot allocate %lu records\n", n);
+      return -1;
+    }
+    t->mask = n - 1;
+  }
+
+  sim_trace_enter(t);
+  return 0;
+}
+
+void sim_trace_deinit(sim_trace_t* t) {
+  if (sim_trace_active == t) {
+    sim_trace_active = NULL;
+  }
+  free(t->records);
+  t->records = NULL;
+}
+
+void sim_trace_dump(sim_trace_t* t, FILE* f) {
+  if (t->mode != SIM_TRACE_RING) {
+    return;
+  }
+
+  uint64_t size  = t->mask + 1;
+  uint64_t first = t->head > size ? t->head - size : 0;
+
+  fprintf(f, "trace: %lu records, %lu overwritten\n", t->head - first, first);
+  for (uint64_t i = first; i < t->head; i++) {
+    sim_trace_record_t* r = &t->records[i & t->mask];
+    fprintf(f, "[%lf] ", sim_time_to_double(r->time));
+    sim_trace_print(f, r->fmt, r->args);
+  }
+  fflush(f);
+}
+
+void sim_trace_error(void) {
+  sim_trace_t* t = sim_trace_active;
+
+  if (t && t->mode == SIM_TRACE_RING && !t->dumped_on_error) {
+    t->dumped_on_error = true;
+    sim_trace_dump(t, stderr);
+  }
+}
+
+void sim_trace_print(FILE* f, const char* fmt, const uint64_t* args) {
+  int n = 0;
+
+  while (*fmt) {
+    // copy literal text up to the next conversion
+    if (*fmt != '%') {
+      const char* next = strchr(fmt, '%');
+      size_t len = next ? (size_t)(next - fmt) : strlen(fmt);
+      fwrite(fmt, 1, len, f);
+      fmt += len;
+      continue;
+    }
+    if (fmt[1] == '%') {
+      fputc('%', f);
+      fmt += 2;
+      continue;
+    }
+
+    // collect one conversion specification, flags through conversion
+    char spec[32];
+    int len = 0;
+    spec[len++] = *fmt++;
+    while (*fmt && !strchr("diouxXcsfFeEgGaAp", *fmt) && len < (int)sizeof(spec) - 2) {
+      spec[len++] = *fmt++;
+    }
+    if (!*fmt) {
+      break;
+    }
+    char conv   = *fmt++;
+    spec[len++] = conv;
+    spec[len]   = 0;
+
+    uint64_t a   = n < SIM_TRACE_MAX_ARGS ? args[n++] : 0;
+    bool is_long = strpbrk(spec, "ljzt") != NULL;
+    double d;
+
+    switch (conv) {
+      case 'f': case 'F': case 'e': case 'E':
+      case 'g': case 'G': case 'a': case 'A':
+        memcpy(&d, &a, sizeof(d));
+        fprintf(f, spec, d);
+        break;
+      case 's':
+        fprintf(f, spec, (const char*)(uintptr_t)a);
+        break;
+      case 'p':
+        fprintf(f, spec, (void*)(uintptr_t)a);
+        break;
+      case 'c':
+        fprintf(f, spec, (int)a);
+        break;
+      case 'd': case 'i':
+        if (is_long) {
+          fprintf(f, spec, (long)a);
+        } else {
+          fprintf(f, spec, (int)a);
+        }
+        break;
+      default:
+        if (is_long) {
+          fprintf(f, spec, (unsigned long)a);
+        } else {
+          fprintf(f, spec, (unsigned)a);
+        }
+        break;
+    }
+  }
+}
@@ -0,0 +1,141 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "simtime.h"
+
+
+// The trace is a flight recorder for DEBUG() statements
+// Instead of formatting a message to stderr, a trace point stores its
+// format string, the simulated time, and its raw arguments into a ring
+// buffer owned by the simulation context
+// Messages are only formatted when the ring is dumped: on an ERROR(), on
+// a DUMP_TRACE command in the workload, and into logs/queuesim.trace.out
+// when the simulation finishes (if the trace log is on)
+//
+// Because formatting is deferred, a trace point may take at most
+// SIM_TRACE_MAX_ARGS arguments, and its format string and any %s
+// arguments must be string literals (or otherwise live forever)
+
+typedef enum {
+  SIM_TRACE_RING,   // record into the ring (default)
+  SIM_TRACE_STDERR, // format and print each message immediately
+  SIM_TRACE_OFF,    // discard all messages
+} sim_trace_mode_t;
+
+#define SIM_TRACE_MAX_ARGS     6
+#define SIM_TRACE_DEFAULT_SIZE 65536
+
+// one trace point, exactly one cache line
+typedef struct sim_trace_record {
+  const char* fmt;
+  sim_time_t time;
+  uint64_t args[SIM_TRACE_MAX_ARGS];
+} sim_trace_record_t;
+
+typedef struct sim_trace {
+  sim_trace_mode_t mode;
+  uint64_t mask;       // number of records - 1 (a power of 2)
+  uint64_t head;       // total number of records ever written
+  sim_trace_record_t* records;
+  const sim_time_t* now; // simulated time to stamp records with
+  bool dumped_on_error;
+} sim_trace_t;
+
+// trace that trace points in this thread go to, set by sim_trace_init()
+// and by sim_trace_enter() whenever a context starts work, so contexts
+// that take turns in one thread (or run in several) each keep their own
+// without one, messages are printed immediately
+extern _Thread_local sim_trace_t* sim_trace_active;
+
+
+// set up a trace with (at least) size records and make it active
+int  sim_trace_init(sim_trace_t* t, sim_trace_mode_t mode, uint64_t size, const sim_time_t* now);
+void sim_trace_deinit(sim_trace_t* t);
+
+// send this thread's trace points to t
+static inline void sim_trace_enter(sim_trace_t* t) {
+  sim_trace_active = t;
+}
+
+// format every record still in the ring, oldest first
+void sim_trace_dump(sim_trace_t* t, FILE* f);
+
+// dump the active trace to stderr, once, when an error occurs
+void sim_trace_error(void);
+
+// format one message from its raw arguments
+void sim_trace_print(FILE* f, const char* fmt, const uint64_t* args);
+
+
+/* Trace points */
+
+static inline uint64_t sim_trace_arg_double(double d) {
+  uint64_t v;
+  memcpy(&v, &d, sizeof(v));
+  return v;
+}
+
+static inline uint64_t sim_trace_arg_int(uint64_t v) {
+  return v;
+}
+
+static inline uint64_t sim_trace_arg_ptr(const void* p) {
+  return (uintptr_t)p;
+}
+
+// store an argument as 64 raw bits, keeping floating point values intact
+#define SIM_TRACE_ARG(x) _Generic((x),        \
+    float: sim_trace_arg_double,              \
+    double: sim_trace_arg_double,             \
+    char*: sim_trace_arg_ptr,                 \
+    const char*: sim_trace_arg_ptr,           \
+    void*: sim_trace_arg_ptr,                 \
+    const void*: sim_trace_arg_ptr,           \
+    default: sim_trace_arg_int)(x)
+
+#define SIM_TRACE_NARGS(args...) SIM_TRACE_NARGS_(_, ##args, 6, 5, 4, 3, 2, 1, 0)
+#define SIM_TRACE_NARGS_(_, a1, a2, a3, a4, a5, a6, n, ...) n
+
+#define SIM_TRACE_CAT(a, b)  SIM_TRACE_CAT_(a, b)
+#define SIM_TRACE_CAT_(a, b) a##b
+
+#define SIM_TRACE_MAP(args...) SIM_TRACE_CAT(SIM_TRACE_MAP_, SIM_TRACE_NARGS(args))(args)
+#define SIM_TRACE_MAP_0()
+#define SIM_TRACE_MAP_1(a)                SIM_TRACE_ARG(a)
+#define SIM_TRACE_MAP_2(a, b)             SIM_TRACE_MAP_1(a), SIM_TRACE_ARG(b)
+#define SIM_TRACE_MAP_3(a, b, c)          SIM_TRACE_MAP_2(a, b), SIM_TRACE_ARG(c)
+#define SIM_TRACE_MAP_4(a, b, c, d)       SIM_TRACE_MAP_3(a, b, c), SIM_TRACE_ARG(d)
+#define SIM_TRACE_MAP_5(a, b, c, d, e)    SIM_TRACE_MAP_4(a, b, c, d), SIM_TRACE_ARG(e)
+#define SIM_TRACE_MAP_6(a, b, c, d, e, f) SIM_TRACE_MAP_5(a, b, c, d, e), SIM_TRACE_ARG(f)
+
+static inline void sim_trace_record(const char* fmt, const uint64_t* args) {
+  sim_trace_t* t = sim_trace_active;
+
+  if (__builtin_expect(!t || t->mode == SIM_TRACE_STDERR, 0)) {
+    sim_trace_print(stderr, fmt, args);
+    return;
+  }
+  if (t->mode == SIM_TRACE_OFF) {
+    return;
+  }
+
+  sim_trace_record_t* r = &t->records[t->head++ & t->mask];
+  r->fmt  = fmt;
+  r->time = *t->now;
+  memcpy(r->args, args, sizeof(r->args));
+}
+
+// record a trace point, with printf-style format and arguments
+#define SIM_TRACE(fmt, args...) \
+  sim_trace_record(fmt, (const uint64_t[SIM_TRACE_MAX_ARGS]){ SIM_TRACE_MAP(args) })
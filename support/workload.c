@@ -0,0 +1,741 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "context.h"
+#include "debug.h"
+#include "generator.h"
+#include "workload.h"
+
+
+// control debugging prints throughout this file
+#if DEBUG_WORKLOAD
+#define DEBUG(fmt, args...) DEBUG_PRINT("workload: " fmt, ##args)
+#else
+#define DEBUG(fmt, args...)
+#endif
+#define ERROR(fmt, args...) ERROR_PRINT("workload: " fmt, ##args)
+#define INFO(fmt, args...)  INFO_PRINT("workload: " fmt, ##args)
+
+
+/* Keywords */
+
+typedef struct keyword {
+  char* name;
+  sim_event_type_t type;
+} keyword_t;
+
+static keyword_t keywords[] = {
+  { "APERIODIC_JOB_ARRIVAL", SIM_EVENT_APERIODIC_JOB_ARRIVAL },
+  { "SPORADIC_JOB_ARRIVAL",  SIM_EVENT_SPORADIC_JOB_ARRIVAL },
+  { "PERIODIC_TASK_ARRIVAL", SIM_EVENT_PERIODIC_TASK_ARRIVAL },
+  { "PRINT_ALL",             SIM_EVENT_PRINT_ALL },
+  { "PRINT_STATS",           SIM_EVENT_PRINT_STATS },
+  { "PRINT_JOB_QUEUES",      SIM_EVENT_PRINT_JOB_QUEUES },
+  { "PRINT_EVENT_QUEUE",     SIM_EVENT_PRINT_EVENT_QUEUE },
+  { "DISPLAY_QUEUE_DEPTHS",  SIM_EVENT_DISPLAY_QUEUE_DEPTHS },
+  { "DUMP_TRACE",            SIM_EVENT_DUMP_TRACE },
+};
+
+#define NUM_KEYWORDS (sizeof(keywords) / sizeof(keywords[0]))
+
+// length plus (case-folded) first character happens to be a perfect hash
+// of the keywords above; a new keyword that collides needs a new hash
+#define KEYWORD_TABLE_SIZE 16
+#define KEYWORD_HASH(first, len) (((len) + ((first) | 0x20)) & (KEYWORD_TABLE_SIZE - 1))
+
+static keyword_t* keyword_table[KEYWORD_TABLE_SIZE];
+
+__attribute__((constructor)) static void keyword_table_init(void) {
+  for (size_t i = 0; i < NUM_KEYWORDS; i++) {
+    keyword_t* k = &keywords[i];
+    int h = KEYWORD_HASH(k->name[0], strlen(k->name));
+    if (keyword_table[h]) {
+      ERROR("keywords %s and %s collide\n", keyword_table[h]->name, k->name);
+      exit(-1);
+    }
+    keyword_table[h] = k;
+  }
+}
+
+static keyword_t* keyword_find(const char* p, size_t len) {
+  keyword_t* k = keyword_table[KEYWORD_HASH(p[0], len)];
+  if (k && strlen(k->name) == len && !strncasecmp(k->name, p, len)) {
+    return k;
+  }
+  return NULL;
+}
+
+
+/* Number parsing */
+
+static inline bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+static inline bool is_digit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static inline const char* skip_space(const char* p, const char* end) {
+  while (p < end && is_space(*p)) {
+    p++;
+  }
+  return p;
+}
+
+static inline const char* skip_token(const char* p, const char* end) {
+  while (p < end && !is_space(*p)) {
+    p++;
+  }
+  return p;
+}
+
+// copy the token at p into a terminated buffer for the C library
+static void copy_token(const char* p, const char* end, char* buf, size_t size) {
+  size_t len = skip_token(p, end) - p;
+  if (len > size - 1) {
+    len = size - 1;
+  }
+  memcpy(buf, p, len);
+  buf[len] = 0;
+}
+
+// the slow path, exactly what the original sscanf()-based loader did
+static bool parse_seconds_slow(const char** pp, const char* end, sim_time_t* t) {
+  char buf[64];
+  char* stop;
+  copy_token(*pp, end, buf, sizeof(buf));
+  double d = strtod(buf, &stop);
+  if (stop == buf) {
+    return false;
+  }
+  *t  = sim_time_from_double(d);
+  *pp = skip_token(*pp, end);
+  return true;
+}
+
+// parse a decimal number of seconds straight to ticks
+// The exact decimal value is rounded to the nearest tick, which matches
+// llround(strtod(s) * SIM_TIME_TICKS_PER_SEC) unless the exact value is
+// so close to halfway between ticks that the rounding errors of the
+// floating point route could matter; those (and exponents, huge values,
+// and anything else unusual) take the slow path to stay identical
+static bool parse_seconds(const char** pp, const char* end, sim_time_t* t) {
+  const char* p = skip_space(*pp, end);
+  *pp = p;
+
+  bool neg = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    neg = *p == '-';
+    p++;
+  }
+
+  uint64_t whole = 0;
+  int nwhole     = 0;
+  while (p < end && is_digit(*p)) {
+    whole = whole * 10 + (*p++ - '0');
+    nwhole++;
+  }
+
+  // first 9 fraction digits are ticks, the next 9 decide rounding
+  uint64_t frac = 0, rest = 0;
+  int nfrac     = 0, nrest = 0;
+  bool sticky   = false;
+  if (p < end && *p == '.') {
+    p++;
+    while (p < end && is_digit(*p)) {
+      int d = *p++ - '0';
+      if (nfrac < 9) {
+        frac = frac * 10 + d;
+        nfrac++;
+      } else if (nrest < 9) {
+        rest = rest * 10 + d;
+        nrest++;
+      } else {
+        sticky |= d != 0;
+      }
+    }
+  }
+
+  if ((nwhole == 0 && nfrac == 0) || nwhole > 9 || (p < end && !is_space(*p))) {
+    return parse_seconds_slow(pp, end, t);
+  }
+
+  for (; nfrac < 9; nfrac++) {
+    frac *= 10;
+  }
+  for (; nrest < 9; nrest++) {
+    rest *= 10;
+  }
+
+  uint64_t ticks = whole * SIM_TIME_TICKS_PER_SEC + frac;
+
+  // distance of the remainder from halfway, against the worst-case error
+  // of strtod() and the multiplication (and of ignoring sticky digits)
+  double bound = ticks * 4e-16 + (sticky ? 1e-9 : 0);
+  double dist  = (double)rest * 1e-9 - 0.5;
+  if (dist < 0) {
+    dist = -dist;
+  }
+  if (dist <= bound) {
+    return parse_seconds_slow(pp, end, t);
+  }
+  if (rest > 500000000) {
+    ticks++;
+  }
+
+  *t  = neg ? -(sim_time_t)ticks : (sim_time_t)ticks;
+  *pp = p;
+  return true;
+}
+
+static bool parse_int_slow(const char** pp, const char* end, int64_t* v) {
+  char buf[64];
+  char* stop;
+  copy_token(*pp, end, buf, sizeof(buf));
+  *v = strtoll(buf, &stop, 10);
+  if (stop == buf) {
+    return false;
+  }
+  *pp = skip_token(*pp, end);
+  return true;
+}
+
+static bool parse_int(const char** pp, const char* end, int64_t* v) {
+  const char* p = skip_space(*pp, end);
+  *pp = p;
+
+  uint64_t x = 0;
+  int n      = 0;
+  while (p < end && is_digit(*p) && n < 18) {
+    x = x * 10 + (*p++ - '0');
+    n++;
+  }
+
+  if (n == 0 || (p < end && !is_space(*p))) {
+    return parse_int_slow(pp, end, v);
+  }
+
+  *v  = x;
+  *pp = p;
+  return true;
+}
+
+
+/* Public functions */
+
+bool sim_workload_parse_line(const char* p, const char* end, sim_workload_cmd_t* cmd) {
+  memset(cmd, 0, sizeof(*cmd));
+
+  p = skip_space(p, end);
+  if (p == end || *p == '#') {
+    return false;
+  }
+
+  if (!parse_seconds(&p, end, &cmd->time)) {
+    return false;
+  }
+
+  p = skip_space(p, end);
+  const char* word = p;
+  p = skip_token(p, end);
+  if (p == word) {
+    return false;
+  }
+
+  keyword_t* k = keyword_find(word, p - word);
+  if (!k) {
+    return false;
+  }
+  cmd->type = k->type;
+
+  // arguments are parsed in order until one is missing
+  int64_t i;
+  switch (cmd->type) {
+    case SIM_EVENT_APERIODIC_JOB_ARRIVAL:
+      if (parse_seconds(&p, end, &cmd->size) && parse_int(&p, end, &i)) {
+        cmd->priority = i;
+      }
+      break;
+
+    case SIM_EVENT_SPORADIC_JOB_ARRIVAL:
+      if (parse_seconds(&p, end, &cmd->size)) {
+        parse_seconds(&p, end, &cmd->deadline);
+      }
+      break;
+
+    case SIM_EVENT_PERIODIC_TASK_ARRIVAL:
+      if (parse_seconds(&p, end, &cmd->period) &&
+          parse_seconds(&p, end, &cmd->size) &&
+          parse_int(&p, end, &i)) {
+        cmd->numiters = (int)i;
+      }
+      break;
+
+    default:
+      // no arguments
+      break;
+  }
+
+  return true;
+}
+
+// add commands from the text workload in [data, data + len)
+static int parse_text(const char* data, size_t len, sim_workload_fn_t fn, void* arg) {
+  const char* p   = data;
+  const char* end = data + len;
+
+  while (p < end) {
+    const char* eol = memchr(p, '\n', end - p);
+    if (!eol) {
+      eol = end;
+    }
+
+    sim_workload_cmd_t cmd;
+    if (sim_workload_parse_line(p, eol, &cmd) && fn(arg, &cmd)) {
+      return -1;
+    }
+
+    p = eol + 1;
+  }
+
+  return 0;
+}
+
+static size_t record_size[SIM_WORKLOAD_NUM_GROUPS] = {
+  [SIM_WORKLOAD_APERIODIC] = sizeof(sim_workload_aperiodic_t),
+  [SIM_WORKLOAD_SPORADIC]  = sizeof(sim_workload_sporadic_t),
+  [SIM_WORKLOAD_PERIODIC]  = sizeof(sim_workload_periodic_t),
+  [SIM_WORKLOAD_COMMANDS]  = sizeof(sim_workload_command_t),
+};
+
+static bool is_binary(const char* data, size_t len) {
+  return len >= sizeof(sim_workload_header_t) &&
+         !memcmp(data, SIM_WORKLOAD_MAGIC, sizeof(SIM_WORKLOAD_MAGIC));
+}
+
+// add commands from the binary workload in [data, data + len)
+// the groups are merged back into the order of the original text
+static int load_binary(const char* data, size_t len, sim_workload_fn_t fn, void* arg) {
+  sim_workload_header_t* h = (sim_workload_header_t*)data;
+
+  if (h->version != SIM_WORKLOAD_VERSION ||
+      h->byte_order != SIM_WORKLOAD_BYTE_ORDER ||
+      h->ticks_per_sec != SIM_TIME_TICKS_PER_SEC) {
+    ERROR("unsupported binary workload (version %u byte order %x ticks %lu)\n",
+          h->version, h->byte_order, h->ticks_per_sec);
+    return -1;
+  }
+
+  const char* group[SIM_WORKLOAD_NUM_GROUPS];
+  uint64_t next[SIM_WORKLOAD_NUM_GROUPS] = { 0 };
+  size_t expected = sizeof(*h);
+  for (int g = 0; g < SIM_WORKLOAD_NUM_GROUPS; g++) {
+    group[g]  = data + expected;
+    expected += h->num_records[g] * record_size[g];
+  }
+  if (expected != len) {
+    ERROR("binary workload is %lu bytes, expected %lu\n", len, expected);
+    return -1;
+  }
+
+  while (1) {
+    // every record starts with its time and sequence number
+    int best = -1;
+    sim_time_t best_time = 0;
+    uint64_t best_seq    = 0;
+    for (int g = 0; g < SIM_WORKLOAD_NUM_GROUPS; g++) {
+      if (next[g] < h->num_records[g]) {
+        sim_time_t* r = (sim_time_t*)(group[g] + next[g] * record_size[g]);
+        uint64_t seq  = r[1];
+        if (best < 0 || r[0] < best_time || (r[0] == best_time && seq < best_seq)) {
+          best      = g;
+          best_time = r[0];
+          best_seq  = seq;
+        }
+      }
+    }
+    if (best < 0) {
+      return 0;
+    }
+
+    const char* rec = group[best] + next[best]++ * record_size[best];
+    sim_workload_cmd_t cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.time = best_time;
+
+    switch (best) {
+      case SIM_WORKLOAD_APERIODIC: {
+        sim_workload_aperiodic_t* a = (sim_workload_aperiodic_t*)rec;
+        cmd.type     = SIM_EVENT_APERIODIC_JOB_ARRIVAL;
+        cmd.size     = a->size;
+        cmd.priority = a->priority;
+        break;
+      }
+      case SIM_WORKLOAD_SPORADIC: {
+        sim_workload_sporadic_t* sp = (sim_workload_sporadic_t*)rec;
+        cmd.type     = SIM_EVENT_SPORADIC_JOB_ARRIVAL;
+        cmd.size     = sp->size;
+        cmd.deadline = sp->deadline;
+        break;
+      }
+      case SIM_WORKLOAD_PERIODIC: {
+        sim_workload_periodic_t* pe = (sim_workload_periodic_t*)rec;
+        cmd.type     = SIM_EVENT_PERIODIC_TASK_ARRIVAL;
+        cmd.period   = pe->period;
+        cmd.size     = pe->size;
+        cmd.numiters = pe->numiters;
+        break;
+      }
+      default: {
+        sim_workload_command_t* c = (sim_workload_command_t*)rec;
+        cmd.type = c->type;
+        break;
+      }
+    }
+
+    if (fn(arg, &cmd)) {
+      return -1;
+    }
+  }
+}
+
+int sim_workload_read(char* path, sim_workload_fn_t fn, void* arg) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    ERROR("cannot open %s\n", path);
+    return -1;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st)) {
+    ERROR("cannot stat %s\n", path);
+    close(fd);
+    return -1;
+  }
+
+  if (st.st_size == 0) {
+    close(fd);
+    return 0;
+  }
+
+  char* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    ERROR("cannot map %s\n", path);
+    return -1;
+  }
+  madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+  int rc;
+  if (is_binary(data, st.st_size)) {
+    // no path: the trace formats it later, and path may be gone by then
+    DEBUG("binary workload\n");
+    rc = load_binary(data, st.st_size, fn, arg);
+  } else {
+    rc = parse_text(data, st.st_size, fn, arg);
+  }
+
+  munmap(data, st.st_size);
+  return rc;
+}
+
+static int add_to_context(void* arg, sim_workload_cmd_t* cmd) {
+  return sim_context_add_command((sim_context_t*)arg, cmd);
+}
+
+int sim_workload_load(sim_context_t* context, char* path) {
+  return sim_workload_read(path, add_to_context, context);
+}
+
+
+/* Incremental workload sources */
+
+// a text workload read a line at a time from a pipe
+typedef struct stream_source {
+  sim_workload_source_t source;
+  FILE* file;
+  char* line;
+  size_t size;
+  uint64_t lineno;
+} stream_source_t;
+
+static int stream_next(sim_workload_source_t* s, sim_workload_cmd_t* cmd) {
+  stream_source_t* ss = (stream_source_t*)s;
+  ssize_t len;
+
+  while ((len = getline(&ss->line, &ss->size, ss->file)) >= 0) {
+    ss->lineno++;
+    if (ss->lineno == 1 && len >= 7 && !memcmp(ss->line, SIM_WORKLOAD_MAGIC, 7)) {
+      ERROR("binary workloads cannot be streamed, convert to text first\n");
+      return -1;
+    }
+    if (sim_workload_parse_line(ss->line, ss->line + len, cmd)) {
+      return 1;
+    }
+  }
+
+  if (ferror(ss->file)) {
+    ERROR("cannot read workload at line %lu\n", ss->lineno + 1);
+    return -1;
+  }
+  return 0;
+}
+
+static void stream_close(sim_workload_source_t* s) {
+  stream_source_t* ss = (stream_source_t*)s;
+
+  if (ss->file != stdin) {
+    fclose(ss->file);
+  }
+  free(ss->line);
+}
+
+// a synthetic workload generated as the simulation runs
+typedef struct gen_source {
+  sim_workload_source_t source;
+  sim_gen_t gen;
+} gen_source_t;
+
+static int gen_next(sim_workload_source_t* s, sim_workload_cmd_t* cmd) {
+  return sim_gen_next(&((gen_source_t*)s)->gen, cmd);
+}
+
+static void gen_close(sim_workload_source_t* s) {
+}
+
+static sim_workload_source_t* gen_source_open(char* spec) {
+  sim_gen_config_t config;
+  if (sim_gen_config_init(&config) || sim_gen_config_parse(&config, spec)) {
+    return NULL;
+  }
+
+  gen_source_t* gs = malloc(sizeof(*gs));
+  if (!gs) {
+    ERROR("cannot allocate source\n");
+    return NULL;
+  }
+  memset(&gs->source, 0, sizeof(gs->source));
+  sim_gen_init(&gs->gen, &config);
+
+  gs->source.next  = gen_next;
+  gs->source.close = gen_close;
+  return &gs->source;
+}
+
+static bool is_gen(char* path) {
+  return !strncmp(path, SIM_WORKLOAD_GEN_PREFIX, strlen(SIM_WORKLOAD_GEN_PREFIX));
+}
+
+bool sim_workload_is_source(char* path) {
+  struct stat st;
+  return !strcmp(path, "-") || is_gen(path) || (!stat(path, &st) && !S_ISREG(st.st_mode));
+}
+
+sim_workload_source_t* sim_workload_source_open(char* path) {
+  if (is_gen(path)) {
+    return gen_source_open(path + strlen(SIM_WORKLOAD_GEN_PREFIX));
+  }
+
+  stream_source_t* ss = calloc(1, sizeof(*ss));
+  if (!ss) {
+    ERROR("cannot allocate source\n");
+    return NULL;
+  }
+
+  ss->file = strcmp(path, "-") ? fopen(path, "r") : stdin;
+  if (!ss->file) {
+    ERROR("cannot open %s\n", path);
+    free(ss);
+    return NULL;
+  }
+
+  ss->source.next  = stream_next;
+  ss->source.close = stream_close;
+  return &ss->source;
+}
+
+sim_workload_cmd_t* sim_workload_source_peek(sim_workload_source_t* s) {
+  while (!s->pending && !s->done) {
+    int rc = s->next(s, &s->cmd);
+    if (rc <= 0) {
+      s->done = true;
+    } else if (s->cmd.time < s->last_time) {
+      ERROR("command at %lf is before the previous one at %lf, skipped\n",
+            sim_time_to_double(s->cmd.time), sim_time_to_double(s->last_time));
+    } else {
+      s->pending   = true;
+      s->last_time = s->cmd.time;
+    }
+  }
+
+  return s->pending ? &s->cmd : NULL;
+}
+
+void sim_workload_source_pop(sim_workload_source_t* s) {
+  s->pending = false;
+}
+
+void sim_workload_source_close(sim_workload_source_t* s) {
+  if (s) {
+    s->close(s);
+    free(s);
+  }
+}
+
+
+/* Binary workload creation */
+
+static void print_seconds(FILE* f, sim_time_t t) {
+  if (t < 0) {
+    fputc('-', f);
+    t = -t;
+  }
+  fprintf(f, "%ld.%09ld", (long)(t / SIM_TIME_TICKS_PER_SEC), (long)(t % SIM_TIME_TICKS_PER_SEC));
+}
+
+void sim_workload_print_cmd(FILE* f, sim_workload_cmd_t* cmd) {
+  print_seconds(f, cmd->time);
+
+  for (size_t i = 0; i < NUM_KEYWORDS; i++) {
+    if (keywords[i].type == cmd->type) {
+      fprintf(f, " %s", keywords[i].name);
+      break;
+    }
+  }
+
+  switch (cmd->type) {
+    case SIM_EVENT_APERIODIC_JOB_ARRIVAL:
+      fputc(' ', f);
+      print_seconds(f, cmd->size);
+      fprintf(f, " %lu", cmd->priority);
+      break;
+
+    case SIM_EVENT_SPORADIC_JOB_ARRIVAL:
+      fputc(' ', f);
+      print_seconds(f, cmd->size);
+      fputc(' ', f);
+      print_seconds(f, cmd->deadline);
+      break;
+
+    case SIM_EVENT_PERIODIC_TASK_ARRIVAL:
+      fputc(' ', f);
+      print_seconds(f, cmd->period);
+      fputc(' ', f);
+      print_seconds(f, cmd->size);
+      fprintf(f, " %lu", cmd->numiters);
+      break;
+
+    default:
+      break;
+  }
+
+  fputc('\n', f);
+}
+
+void sim_workload_writer_init(sim_workload_writer_t* w) {
+  memset(w, 0, sizeof(*w));
+}
+
+int sim_workload_writer_add(sim_workload_writer_t* w, sim_workload_cmd_t* cmd) {
+  int g;
+  switch (cmd->type) {
+    case SIM_EVENT_APERIODIC_JOB_ARRIVAL: g = SIM_WORKLOAD_APERIODIC; break;
+    case SIM_EVENT_SPORADIC_JOB_ARRIVAL:  g = SIM_WORKLOAD_SPORADIC; break;
+    case SIM_EVENT_PERIODIC_TASK_ARRIVAL: g = SIM_WORKLOAD_PERIODIC; break;
+    default:                              g = SIM_WORKLOAD_COMMANDS; break;
+  }
+
+  if (w->num[g] == w->cap[g]) {
+    uint64_t cap = w->cap[g] ? w->cap[g] * 2 : 1024;
+    char* recs   = realloc(w->records[g], cap * record_size[g]);
+    if (!recs) {
+      ERROR("cannot grow workload\n");
+      return -1;
+    }
+    w->records[g] = recs;
+    w->cap[g]     = cap;
+  }
+
+  char* rec = w->records[g] + w->num[g]++ * record_size[g];
+  uint64_t seq = w->seq++;
+
+  switch (g) {
+    case SIM_WORKLOAD_APERIODIC:
+      *(sim_workload_aperiodic_t*)rec = (sim_workload_aperiodic_t){
+        .time = cmd->time, .seq = seq, .size = cmd->size, .priority = cmd->priority };
+      break;
+    case SIM_WORKLOAD_SPORADIC:
+      *(sim_workload_sporadic_t*)rec = (sim_workload_sporadic_t){
+        .time = cmd->time, .seq = seq, .size = cmd->size, .deadline = cmd->deadline };
+      break;
+    case SIM_WORKLOAD_PERIODIC:
+      *(sim_workload_periodic_t*)rec = (sim_workload_periodic_t){
+        .time = cmd->time, .seq = seq, .period = cmd->period, .size = cmd->size,
+        .numiters = cmd->numiters };
+      break;
+    default:
+      *(sim_workload_command_t*)rec = (sim_workload_command_t){
+        .time = cmd->time, .seq = seq, .type = cmd->type };
+      break;
+  }
+
+  return 0;
+}
+
+// order records by time, then by position in the original workload
+static int compare_records(const void* a, const void* b) {
+  const sim_time_t* x = a;
+  const sim_time_t* y = b;
+  if (x[0] != y[0]) {
+    return x[0] < y[0] ? -1 : 1;
+  }
+  return (uint64_t)x[1] < (uint64_t)y[1] ? -1 : (uint64_t)x[1] > (uint64_t)y[1];
+}
+
+int sim_workload_writer_write(sim_workload_writer_t* w, FILE* f) {
+  sim_workload_header_t h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, SIM_WORKLOAD_MAGIC, sizeof(SIM_WORKLOAD_MAGIC));
+  h.version       = SIM_WORKLOAD_VERSION;
+  h.byte_order    = SIM_WORKLOAD_BYTE_ORDER;
+  h.ticks_per_sec = SIM_TIME_TICKS_PER_SEC;
+
+  for (int g = 0; g < SIM_WORKLOAD_NUM_GROUPS; g++) {
+    h.num_records[g] = w->num[g];
+    qsort(w->records[g], w->num[g], record_size[g], compare_records);
+  }
+
+  if (fwrite(&h, sizeof(h), 1, f) != 1) {
+    return -1;
+  }
+  for (int g = 0; g < SIM_WORKLOAD_NUM_GROUPS; g++) {
+    if (w->num[g] && fwrite(w->records[g], record_size[g], w->num[g], f) != w->num[g]) {
+      return -1;
+    }
+  }
+
+  return 0;
+}
+
+void sim_workload_writer_deinit(sim_workload_writer_t* w) {
+  for (int g = 0; g < SIM_WORKLOAD_NUM_GROUPS; g++) {
+    free(w->records[g]);
+  }
+}
@@ -0,0 +1,168 @@
+/*
+ *  Queueing/Scheduling Lab
+ *
+ *  Copyright (c) 2022 Peter Dinda, Branden Ghena
+ *
+ *  Original Queuesim tool is Copyright (c) 2005 Peter Dinda
+ */
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "event.h"
+#include "simtime.h"
+
+
+// forward declaration to avoid header dependency
+typedef struct sim_context sim_context_t;
+
+
+// A text workload has one command per line:
+//   timestamp APERIODIC_JOB_ARRIVAL size priority
+//   timestamp SPORADIC_JOB_ARRIVAL size deadline
+//   timestamp PERIODIC_TASK_ARRIVAL period size numiters
+//   timestamp PRINT_ALL | PRINT_STATS | PRINT_JOB_QUEUES |
+//             PRINT_EVENT_QUEUE | DISPLAY_QUEUE_DEPTHS | DUMP_TRACE
+// Blank lines and lines starting with # are ignored, as are unknown
+// commands, and missing arguments are zero
+//
+// The file is mapped into memory and tokenized in place, commands are
+// found with a perfect hash of the keyword, and numbers of seconds are
+// converted straight to ticks, with the same result as
+// sim_time_from_double(strtod(...))
+//
+// A workload can also be converted (with queuesim-convert) into a binary
+// file that needs no parsing at all: a header followed by packed records
+// in host byte order, grouped by job type (other commands last) and each
+// group sorted by time.  Records keep their original line number, so a
+// binary workload loads in exactly the order the text one would
+// Loading checks for the binary header and otherwise parses text
+//
+// A workload that is not a regular file (- for stdin, or a FIFO) is a
+// source instead: it is read a command at a time while the simulation
+// runs, so a generator can stream arrivals straight into it.  Commands
+// from a source must be in time order
+// A workload named gen:<spec> is a source that generates a synthetic
+// workload as the simulation runs (see generator.h)
+
+// one command from a workload, times and sizes already in ticks
+typedef struct sim_workload_cmd {
+  sim_event_type_t type;
+  sim_time_t time;
+  sim_time_t size;
+  sim_time_t deadline;  // sporadic jobs
+  sim_time_t period;    // periodic tasks
+  uint64_t priority;    // aperiodic jobs
+  uint64_t numiters;    // periodic tasks
+} sim_workload_cmd_t;
+
+#define SIM_WORKLOAD_MAGIC      "QSIMWKL"
+#define SIM_WORKLOAD_VERSION    1
+#define SIM_WORKLOAD_BYTE_ORDER 0x01020304
+
+#define SIM_WORKLOAD_GEN_PREFIX "gen:"
+
+typedef enum {
+  SIM_WORKLOAD_APERIODIC,
+  SIM_WORKLOAD_SPORADIC,
+  SIM_WORKLOAD_PERIODIC,
+  SIM_WORKLOAD_COMMANDS,
+  SIM_WORKLOAD_NUM_GROUPS,
+} sim_workload_group_t;
+
+typedef struct sim_workload_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t ticks_per_sec;
+  uint64_t num_records[SIM_WORKLOAD_NUM_GROUPS];
+} sim_workload_header_t;
+
+// every record starts with its time and its line in the original workload
+typedef struct sim_workload_aperiodic {
+  sim_time_t time;
+  uint64_t seq;
+  sim_time_t size;
+  uint64_t priority;
+} sim_workload_aperiodic_t;
+
+typedef struct sim_workload_sporadic {
+  sim_time_t time;
+  uint64_t seq;
+  sim_time_t size;
+  sim_time_t deadline;
+} sim_workload_sporadic_t;
+
+typedef struct sim_workload_periodic {
+  sim_time_t time;
+  uint64_t seq;
+  sim_time_t period;
+  sim_time_t size;
+  uint64_t numiters;
+} sim_workload_periodic_t;
+
+typedef struct sim_workload_command {
+  sim_time_t time;
+  uint64_t seq;
+  uint64_t type; // a sim_event_type_t
+} sim_workload_command_t;
+
+// collects commands and writes them as a binary workload
+typedef struct sim_workload_writer {
+  uint64_t seq;
+  char* records[SIM_WORKLOAD_NUM_GROUPS];
+  uint64_t num[SIM_WORKLOAD_NUM_GROUPS];
+  uint64_t cap[SIM_WORKLOAD_NUM_GROUPS];
+} sim_workload_writer_t;
+
+// a workload read incrementally, one command ahead of the simulation
+typedef struct sim_workload_source sim_workload_source_t;
+
+struct sim_workload_source {
+  // produce the next command: 1 if there is one, 0 at the end, -1 on error
+  int  (*next)(sim_workload_source_t* s, sim_workload_cmd_t* cmd);
+  void (*close)(sim_workload_source_t* s);
+
+  bool pending;           // cmd holds the next command
+  bool done;
+  sim_workload_cmd_t cmd;
+  sim_time_t last_time;   // time of the previous command
+};
+
+
+// called for each command read from a workload, nonzero stops reading
+typedef int (*sim_workload_fn_t)(void* arg, sim_workload_cmd_t* cmd);
+
+// parse the line [p, end), returning true if it holds a command
+bool sim_workload_parse_line(const char* p, const char* end, sim_workload_cmd_t* cmd);
+
+// read every command in a text or binary workload file
+int sim_workload_read(char* path, sim_workload_fn_t fn, void* arg);
+
+// add every command in a text or binary workload file to the simulation
+int sim_workload_load(sim_context_t* context, char* path);
+
+// is the workload at path read incrementally as a source?
+bool sim_workload_is_source(char* path);
+
+// open the source at path, NULL on error
+sim_workload_source_t* sim_workload_source_open(char* path);
+
+// the next command from a source (without consuming it), NULL at the end
+sim_workload_cmd_t* sim_workload_source_peek(sim_workload_source_t* s);
+
+// consume the command returned by sim_workload_source_peek()
+void sim_workload_source_pop(sim_workload_source_t* s);
+
+void sim_workload_source_close(sim_workload_source_t* s);
+
+// print a command as a line of a text workload (exactly, to the tick)
+void sim_workload_print_cmd(FILE* f, sim_workload_cmd_t* cmd);
+
+// build a binary workload
+void sim_workload_writer_init(sim_workload_writer_t* w);
+int  sim_workload_writer_add(sim_workload_writer_t* w, sim_workload_cmd_t* cmd);
+int  sim_workload_writer_write(sim_workload_writer_t* w, FILE* f);
+void sim_workload_writer_deinit(sim_workload_writer_t* w);